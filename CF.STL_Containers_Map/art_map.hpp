@@ -0,0 +1,1000 @@
+//
+//  art_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://db.in.tum.de/~leis/papers/ART.pdf
+//    "The Adaptive Radix Tree: ARTful Indexing for Main-Memory Databases"
+//
+
+#ifndef art_map_hpp
+#define art_map_hpp
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include <tuple>
+#include <iterator>
+#include <type_traits>
+#include <concepts>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapart
+namespace cmapart {
+
+/*
+ *  MARK: key_traits
+ *  Maps a key onto a byte string whose lexicographic (unsigned) order
+ *  matches std::less<Key>.
+ */
+template <class Key>
+struct key_traits;
+
+template <>
+struct key_traits<std::string> {
+  // std::char_traits<char>::compare is an unsigned byte compare, so UTF-8
+  //  keys iterate in the same order as std::map<std::string, T>.
+  static auto encode(std::string_view key) -> std::string_view {
+    return key;
+  }
+};
+
+template <std::integral Int>
+struct key_traits<Int> {
+  // big-endian with the sign bit flipped: byte order == numeric order.
+  static auto encode(Int key) -> std::array<char, sizeof(Int)> {
+    using UInt = std::make_unsigned_t<Int>;
+    auto bits = static_cast<UInt>(key);
+    if constexpr (std::is_signed_v<Int>) {
+      bits ^= UInt(1) << (sizeof(Int) * 8 - 1);
+    }
+    std::array<char, sizeof(Int)> bytes;
+    for (auto ix = sizeof(Int); ix-- > 0; ) {
+      bytes[ix] = static_cast<char>(bits & 0xff);
+      if constexpr (sizeof(Int) > 1) { bits >>= 8; }
+    }
+    return bytes;
+  }
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: art_map
+ *  Ordered map over an adaptive radix tree.  Lookups cost O(key length)
+ *  rather than O(log n) key comparisons; inner nodes are path-compressed
+ *  and grow/shrink through Node4/16/48/256.  Leaves are threaded on a
+ *  doubly linked list so iteration is O(1) per step and iterators stay
+ *  valid until their element is erased, as with std::map.
+ */
+template <class Key, class T>
+class art_map {
+public:
+  using key_type        = Key;
+  using mapped_type     = T;
+  using value_type      = std::pair<Key const, T>;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference       = value_type &;
+  using const_reference = value_type const &;
+  using traits_type     = key_traits<Key>;
+
+private:
+  enum class node_kind : std::uint8_t { leaf, n4, n16, n48, n256, };
+
+  struct link {
+    link * prev = nullptr;
+    link * next = nullptr;
+  };
+
+  struct node {
+    explicit node(node_kind knd) : kind(knd) {}
+    node_kind kind;
+  };
+
+  struct leaf : node, link {
+    template <class ... Args>
+    explicit leaf(Args && ... args)
+      : node(node_kind::leaf), value(std::forward<Args>(args) ...) {}
+    value_type value;
+  };
+
+  struct inner : node {
+    explicit inner(node_kind knd) : node(knd) {}
+    std::string   prefix;             // compressed path below the parent's byte
+    leaf *        terminal = nullptr; // key that ends exactly at this node
+    std::uint16_t count = 0;
+  };
+
+  struct node4 : inner {
+    node4() : inner(node_kind::n4) {}
+    std::array<std::uint8_t, 4> keys {};
+    std::array<node *, 4> children {};
+  };
+
+  struct node16 : inner {
+    node16() : inner(node_kind::n16) {}
+    alignas(16) std::array<std::uint8_t, 16> keys {};
+    std::array<node *, 16> children {};
+  };
+
+  struct node48 : inner {
+    node48() : inner(node_kind::n48) {}
+    std::array<std::uint8_t, 256> index {};   // 0 == empty, else slot + 1
+    std::array<node *, 48> children {};
+  };
+
+  struct node256 : inner {
+    node256() : inner(node_kind::n256) {}
+    std::array<node *, 256> children {};
+  };
+
+  using child_ref = std::pair<unsigned, node *>;
+  static constexpr unsigned no_byte = 256;
+
+public:
+  //  MARK: iterator
+  template <bool Const>
+  class basic_iterator {
+    friend class art_map;
+    using link_ptr = std::conditional_t<Const, link const *, link *>;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = art_map::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer   = std::conditional_t<Const, value_type const *, value_type *>;
+    using reference = std::conditional_t<Const, value_type const &, value_type &>;
+
+    basic_iterator() = default;
+    explicit basic_iterator(link_ptr cur) : cur_(cur) {}
+    template <bool C = Const> requires C
+    basic_iterator(basic_iterator<false> const & other) : cur_(other.cur_) {}
+
+    auto operator*() const -> reference { return as_leaf()->value; }
+    auto operator->() const -> pointer { return &as_leaf()->value; }
+    auto operator++() -> basic_iterator & { cur_ = cur_->next; return *this; }
+    auto operator++(int) -> basic_iterator { auto tmp = *this; ++*this; return tmp; }
+    auto operator--() -> basic_iterator & { cur_ = cur_->prev; return *this; }
+    auto operator--(int) -> basic_iterator { auto tmp = *this; --*this; return tmp; }
+
+    friend bool operator==(basic_iterator const &, basic_iterator const &) = default;
+
+  private:
+    auto as_leaf() const {
+      using leaf_ptr = std::conditional_t<Const, leaf const *, leaf *>;
+      return static_cast<leaf_ptr>(cur_);
+    }
+
+    link_ptr cur_ = nullptr;
+    friend class basic_iterator<!Const>;
+  };
+
+  using iterator               = basic_iterator<false>;
+  using const_iterator         = basic_iterator<true>;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  //  MARK: construction
+  art_map() { reset_list(); }
+
+  art_map(std::initializer_list<value_type> init) : art_map() {
+    insert(init.begin(), init.end());
+  }
+
+  template <std::input_iterator It>
+  art_map(It first, It last) : art_map() {
+    insert(first, last);
+  }
+
+  art_map(art_map const & other) : art_map() {
+    insert(other.begin(), other.end());
+  }
+
+  art_map(art_map && other) noexcept : art_map() {
+    adopt(other);
+  }
+
+  auto operator=(art_map const & other) -> art_map & {
+    if (this != &other) {
+      art_map tmp(other);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  auto operator=(art_map && other) noexcept -> art_map & {
+    if (this != &other) {
+      clear();
+      adopt(other);
+    }
+    return *this;
+  }
+
+  ~art_map() { clear(); }
+
+  //  MARK: iterators
+  auto begin()        noexcept -> iterator       { return iterator(head_.next); }
+  auto end()          noexcept -> iterator       { return iterator(&head_); }
+  auto begin()  const noexcept -> const_iterator { return const_iterator(head_.next); }
+  auto end()    const noexcept -> const_iterator { return const_iterator(&head_); }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend()   const noexcept -> const_iterator { return end(); }
+  auto rbegin()        noexcept { return reverse_iterator(end()); }
+  auto rend()          noexcept { return reverse_iterator(begin()); }
+  auto rbegin()  const noexcept { return const_reverse_iterator(end()); }
+  auto rend()    const noexcept { return const_reverse_iterator(begin()); }
+  auto crbegin() const noexcept { return rbegin(); }
+  auto crend()   const noexcept { return rend(); }
+
+  //  MARK: capacity
+  [[nodiscard]] auto empty() const noexcept -> bool { return size_ == 0; }
+  auto size() const noexcept -> size_type { return size_; }
+
+  //  MARK: lookup
+  template <class K = key_type>
+  auto find(K const & key) -> iterator {
+    auto const kb = traits_type::encode(key);
+    auto * lf = find_leaf(view(kb));
+    return lf ? iterator(lf) : end();
+  }
+
+  template <class K = key_type>
+  auto find(K const & key) const -> const_iterator {
+    return const_cast<art_map *>(this)->find(key);
+  }
+
+  template <class K = key_type>
+  auto contains(K const & key) const -> bool { return find(key) != end(); }
+
+  template <class K = key_type>
+  auto count(K const & key) const -> size_type { return contains(key) ? 1 : 0; }
+
+  template <class K = key_type>
+  auto at(K const & key) -> mapped_type & {
+    auto it = find(key);
+    if (it == end()) { throw std::out_of_range("art_map::at"); }
+    return it->second;
+  }
+
+  template <class K = key_type>
+  auto at(K const & key) const -> mapped_type const & {
+    return const_cast<art_map *>(this)->at(key);
+  }
+
+  template <class K = key_type>
+  auto lower_bound(K const & key) -> iterator {
+    auto const kb = traits_type::encode(key);
+    return make_iter(root_ ? lower_leaf(root_, view(kb), 0) : nullptr);
+  }
+
+  template <class K = key_type>
+  auto lower_bound(K const & key) const -> const_iterator {
+    return const_cast<art_map *>(this)->lower_bound(key);
+  }
+
+  template <class K = key_type>
+  auto upper_bound(K const & key) -> iterator {
+    auto const kb = traits_type::encode(key);
+    auto it = lower_bound(key);
+    if (it != end() && view(traits_type::encode(it->first)) == view(kb)) { ++it; }
+    return it;
+  }
+
+  template <class K = key_type>
+  auto upper_bound(K const & key) const -> const_iterator {
+    return const_cast<art_map *>(this)->upper_bound(key);
+  }
+
+  template <class K = key_type>
+  auto equal_range(K const & key) -> std::pair<iterator, iterator> {
+    auto it = find(key);
+    if (it == end()) {
+      auto lb = lower_bound(key);
+      return { lb, lb };
+    }
+    return { it, std::next(it) };
+  }
+
+  template <class K = key_type>
+  auto equal_range(K const & key) const -> std::pair<const_iterator, const_iterator> {
+    auto [lo, hi] = const_cast<art_map *>(this)->equal_range(key);
+    return { lo, hi };
+  }
+
+  /*
+   *  Every element whose key starts with prefix, in order.  Found with two
+   *  O(prefix length) descents rather than a scan.
+   */
+  auto prefix_range(std::string_view prefix) -> std::pair<iterator, iterator>
+  requires std::same_as<Key, std::string> {
+    auto first = lower_bound(prefix);
+    // the first key past the prefix block is the prefix "plus one"
+    auto bound = std::string(prefix);
+    while (!bound.empty() && static_cast<std::uint8_t>(bound.back()) == 0xff) {
+      bound.pop_back();
+    }
+    if (bound.empty()) { return { first, end() }; }
+    bound.back() = static_cast<char>(static_cast<std::uint8_t>(bound.back()) + 1);
+    return { first, lower_bound(bound) };
+  }
+
+  auto prefix_range(std::string_view prefix) const
+  -> std::pair<const_iterator, const_iterator>
+  requires std::same_as<Key, std::string> {
+    auto [lo, hi] = const_cast<art_map *>(this)->prefix_range(prefix);
+    return { lo, hi };
+  }
+
+  //  MARK: modifiers
+  template <class ... Args>
+  auto emplace(Args && ... args) -> std::pair<iterator, bool> {
+    // owned until insert_leaf has linked it: encode may throw, and so
+    //  may the node allocations on the way down
+    auto lf = std::make_unique<leaf>(std::forward<Args>(args) ...);
+    auto const kb = traits_type::encode(lf->value.first);
+    if (auto * found = find_leaf(view(kb))) {
+      return { iterator(found), false };
+    }
+    insert_leaf(root_, view(kb), 0, lf.get());
+    ++size_;
+    return { iterator(lf.release()), true };
+  }
+
+  template <class ... Args>
+  auto try_emplace(key_type const & key, Args && ... args) -> std::pair<iterator, bool> {
+    return try_emplace_impl(key, std::forward<Args>(args) ...);
+  }
+
+  template <class ... Args>
+  auto try_emplace(key_type && key, Args && ... args) -> std::pair<iterator, bool> {
+    return try_emplace_impl(std::move(key), std::forward<Args>(args) ...);
+  }
+
+  auto insert(value_type const & value) -> std::pair<iterator, bool> {
+    return emplace(value);
+  }
+
+  auto insert(value_type && value) -> std::pair<iterator, bool> {
+    return emplace(std::move(value));
+  }
+
+  template <std::input_iterator It>
+  auto insert(It first, It last) -> void {
+    for (; first != last; ++first) { emplace(*first); }
+  }
+
+  auto insert(std::initializer_list<value_type> init) -> void {
+    insert(init.begin(), init.end());
+  }
+
+  template <class M>
+  auto insert_or_assign(key_type const & key, M && obj) -> std::pair<iterator, bool> {
+    auto result = try_emplace(key, std::forward<M>(obj));
+    if (!result.second) { result.first->second = std::forward<M>(obj); }
+    return result;
+  }
+
+  auto operator[](key_type const & key) -> mapped_type & {
+    return try_emplace(key).first->second;
+  }
+
+  auto operator[](key_type && key) -> mapped_type & {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  template <class K = key_type>
+  auto erase(K const & key) -> size_type {
+    if (root_ == nullptr) { return 0; }
+    auto const kb = traits_type::encode(key);
+    auto * lf = erase_leaf(root_, view(kb), 0);
+    if (lf == nullptr) { return 0; }
+    unlink(lf);
+    delete lf;
+    --size_;
+    return 1;
+  }
+
+  auto erase(const_iterator pos) -> iterator {
+    auto next = iterator(const_cast<link *>(pos.cur_->next));
+    erase(pos->first);
+    return next;
+  }
+
+  auto erase(iterator pos) -> iterator { return erase(const_iterator(pos)); }
+
+  auto erase(const_iterator first, const_iterator last) -> iterator {
+    while (first != last) { first = erase(first); }
+    return iterator(const_cast<link *>(last.cur_));
+  }
+
+  auto clear() noexcept -> void {
+    if (root_) { free_tree(root_); }
+    root_ = nullptr;
+    size_ = 0;
+    reset_list();
+  }
+
+  auto swap(art_map & other) noexcept -> void {
+    art_map tmp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  friend auto swap(art_map & lhs, art_map & rhs) noexcept -> void { lhs.swap(rhs); }
+
+  // empty maps never reach std::equal, which GCC would otherwise see
+  //  dereferencing head_ as a leaf (-Warray-bounds)
+  friend auto operator==(art_map const & lhs, art_map const & rhs) -> bool {
+    return lhs.size() == rhs.size()
+        && (lhs.empty() || std::equal(lhs.begin(), lhs.end(), rhs.begin()));
+  }
+
+private:
+  //  MARK: helpers
+  static auto view(std::string_view bytes) -> std::string_view { return bytes; }
+  template <std::size_t N>
+  static auto view(std::array<char, N> const & bytes) -> std::string_view {
+    return { bytes.data(), N };
+  }
+
+  static auto byte_at(std::string_view key, std::size_t ix) -> std::uint8_t {
+    return static_cast<std::uint8_t>(key[ix]);
+  }
+
+  auto make_iter(leaf * lf) -> iterator { return lf ? iterator(lf) : end(); }
+
+  auto reset_list() noexcept -> void { head_.prev = head_.next = &head_; }
+
+  auto adopt(art_map & other) noexcept -> void {
+    root_ = std::exchange(other.root_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+    if (size_ == 0) { reset_list(); return; }
+    head_.next = other.head_.next;
+    head_.prev = other.head_.prev;
+    head_.next->prev = &head_;
+    head_.prev->next = &head_;
+    other.reset_list();
+  }
+
+  static auto link_before(link * pos, link * lnk) -> void {
+    lnk->next = pos;
+    lnk->prev = pos->prev;
+    pos->prev->next = lnk;
+    pos->prev = lnk;
+  }
+
+  static auto link_after(link * pos, link * lnk) -> void {
+    link_before(pos->next, lnk);
+  }
+
+  static auto unlink(link * lnk) -> void {
+    lnk->prev->next = lnk->next;
+    lnk->next->prev = lnk->prev;
+  }
+
+  template <class K, class ... Args>
+  auto try_emplace_impl(K && key, Args && ... args) -> std::pair<iterator, bool> {
+    auto const kb = traits_type::encode(key);
+    if (auto * found = find_leaf(view(kb))) {
+      return { iterator(found), false };
+    }
+    auto lf = std::make_unique<leaf>(std::piecewise_construct,
+                                     std::forward_as_tuple(std::forward<K>(key)),
+                                     std::forward_as_tuple(std::forward<Args>(args) ...));
+    auto const lkb = traits_type::encode(lf->value.first);
+    insert_leaf(root_, view(lkb), 0, lf.get());
+    ++size_;
+    return { iterator(lf.release()), true };
+  }
+
+  //  MARK: node primitives
+  static auto find_child(inner * inr, std::uint8_t byte) -> node ** {
+    switch (inr->kind) {
+      case node_kind::n4: {
+        auto * nd = static_cast<node4 *>(inr);
+        for (unsigned ix = 0; ix < nd->count; ++ix) {
+          if (nd->keys[ix] == byte) { return &nd->children[ix]; }
+        }
+        return nullptr;
+      }
+
+      case node_kind::n16: {
+        auto * nd = static_cast<node16 *>(inr);
+        auto const live = (1u << nd->count) - 1;
+#if defined(__SSE2__)
+        auto const cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+          _mm_load_si128(reinterpret_cast<__m128i const *>(nd->keys.data())));
+        auto const hits = static_cast<unsigned>(_mm_movemask_epi8(cmp)) & live;
+        return hits ? &nd->children[__builtin_ctz(hits)] : nullptr;
+#elif defined(__ARM_NEON)
+        // narrow the 16 byte mask to 4 bits per lane
+        auto const cmp = vceqq_u8(vdupq_n_u8(byte), vld1q_u8(nd->keys.data()));
+        auto const nib = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+        auto const bits = vget_lane_u64(vreinterpret_u64_u8(nib), 0);
+        auto const mask = nd->count == 16 ? ~0ull : (1ull << (nd->count * 4)) - 1;
+        auto const hits = bits & mask;
+        return hits ? &nd->children[__builtin_ctzll(hits) / 4] : nullptr;
+#else
+        (void) live;
+        for (unsigned ix = 0; ix < nd->count; ++ix) {
+          if (nd->keys[ix] == byte) { return &nd->children[ix]; }
+        }
+        return nullptr;
+#endif
+      }
+
+      case node_kind::n48: {
+        auto * nd = static_cast<node48 *>(inr);
+        auto const slot = nd->index[byte];
+        return slot ? &nd->children[slot - 1] : nullptr;
+      }
+
+      case node_kind::n256: {
+        auto * nd = static_cast<node256 *>(inr);
+        return nd->children[byte] ? &nd->children[byte] : nullptr;
+      }
+
+      default:
+        return nullptr;
+    }
+  }
+
+  // first child whose byte is >= from
+  static auto next_child(inner * inr, unsigned from) -> child_ref {
+    switch (inr->kind) {
+      case node_kind::n4:
+        return next_sorted(static_cast<node4 *>(inr), from);
+
+      case node_kind::n16:
+        return next_sorted(static_cast<node16 *>(inr), from);
+
+      case node_kind::n48: {
+        auto * nd = static_cast<node48 *>(inr);
+        for (auto byte = from; byte < 256; ++byte) {
+          if (auto slot = nd->index[byte]) { return { byte, nd->children[slot - 1] }; }
+        }
+        return { no_byte, nullptr };
+      }
+
+      case node_kind::n256: {
+        auto * nd = static_cast<node256 *>(inr);
+        for (auto byte = from; byte < 256; ++byte) {
+          if (nd->children[byte]) { return { byte, nd->children[byte] }; }
+        }
+        return { no_byte, nullptr };
+      }
+
+      default:
+        return { no_byte, nullptr };
+    }
+  }
+
+  // last child whose byte is < before
+  static auto prev_child(inner * inr, unsigned before) -> child_ref {
+    switch (inr->kind) {
+      case node_kind::n4:
+        return prev_sorted(static_cast<node4 *>(inr), before);
+
+      case node_kind::n16:
+        return prev_sorted(static_cast<node16 *>(inr), before);
+
+      case node_kind::n48: {
+        auto * nd = static_cast<node48 *>(inr);
+        for (auto byte = before; byte-- > 0; ) {
+          if (auto slot = nd->index[byte]) { return { byte, nd->children[slot - 1] }; }
+        }
+        return { no_byte, nullptr };
+      }
+
+      case node_kind::n256: {
+        auto * nd = static_cast<node256 *>(inr);
+        for (auto byte = before; byte-- > 0; ) {
+          if (nd->children[byte]) { return { byte, nd->children[byte] }; }
+        }
+        return { no_byte, nullptr };
+      }
+
+      default:
+        return { no_byte, nullptr };
+    }
+  }
+
+  template <class Nd>
+  static auto next_sorted(Nd * nd, unsigned from) -> child_ref {
+    for (unsigned ix = 0; ix < nd->count; ++ix) {
+      if (nd->keys[ix] >= from) { return { nd->keys[ix], nd->children[ix] }; }
+    }
+    return { no_byte, nullptr };
+  }
+
+  template <class Nd>
+  static auto prev_sorted(Nd * nd, unsigned before) -> child_ref {
+    for (auto ix = static_cast<unsigned>(nd->count); ix-- > 0; ) {
+      if (nd->keys[ix] < before) { return { nd->keys[ix], nd->children[ix] }; }
+    }
+    return { no_byte, nullptr };
+  }
+
+  template <class Nd>
+  static auto add_sorted(Nd * nd, std::uint8_t byte, node * child) -> void {
+    unsigned pos = 0;
+    while (pos < nd->count && nd->keys[pos] < byte) { ++pos; }
+    for (auto ix = static_cast<unsigned>(nd->count); ix > pos; --ix) {
+      nd->keys[ix] = nd->keys[ix - 1];
+      nd->children[ix] = nd->children[ix - 1];
+    }
+    nd->keys[pos] = byte;
+    nd->children[pos] = child;
+    ++nd->count;
+  }
+
+  template <class Nd>
+  static auto remove_sorted(Nd * nd, std::uint8_t byte) -> void {
+    unsigned pos = 0;
+    while (nd->keys[pos] != byte) { ++pos; }
+    for (auto ix = pos + 1; ix < nd->count; ++ix) {
+      nd->keys[ix - 1] = nd->keys[ix];
+      nd->children[ix - 1] = nd->children[ix];
+    }
+    --nd->count;
+    nd->children[nd->count] = nullptr;
+  }
+
+  // move prefix, terminal and every child of from into a node of type To
+  template <class To>
+  static auto rehome(inner * from) -> To * {
+    auto * to = new To;
+    to->prefix = std::move(from->prefix);
+    to->terminal = from->terminal;
+    for (auto [byte, child] = next_child(from, 0); child;
+         std::tie(byte, child) = next_child(from, byte + 1)) {
+      put_child(to, static_cast<std::uint8_t>(byte), child);
+    }
+    destroy(from);
+    return to;
+  }
+
+  // add to a node known to have room
+  template <class Nd>
+  static auto put_child(Nd * nd, std::uint8_t byte, node * child) -> void {
+    if constexpr (std::is_same_v<Nd, node48>) {
+      unsigned slot = 0;
+      while (nd->children[slot]) { ++slot; }
+      nd->children[slot] = child;
+      nd->index[byte] = static_cast<std::uint8_t>(slot + 1);
+      ++nd->count;
+    }
+    else if constexpr (std::is_same_v<Nd, node256>) {
+      nd->children[byte] = child;
+      ++nd->count;
+    }
+    else {
+      add_sorted(nd, byte, child);
+    }
+  }
+
+  // a full From grows into a To first; the types are static from here on,
+  //  so no node is ever written through the layout of another
+  template <class From, class To>
+  static auto grow_and_put(node *& ref, inner * inr, std::uint8_t byte, node * child) -> void {
+    if (inr->count < std::tuple_size_v<decltype(From::children)>) {
+      put_child(static_cast<From *>(inr), byte, child);
+      return;
+    }
+    auto * to = rehome<To>(inr);
+    ref = to;
+    put_child(to, byte, child);
+  }
+
+  static auto add_child(node *& ref, inner * inr, std::uint8_t byte, node * child) -> void {
+    switch (inr->kind) {
+      case node_kind::n4:
+        grow_and_put<node4, node16>(ref, inr, byte, child);
+        break;
+
+      case node_kind::n16:
+        grow_and_put<node16, node48>(ref, inr, byte, child);
+        break;
+
+      case node_kind::n48:
+        grow_and_put<node48, node256>(ref, inr, byte, child);
+        break;
+
+      case node_kind::n256:
+        put_child(static_cast<node256 *>(inr), byte, child);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  static auto remove_child(node *& ref, inner * inr, std::uint8_t byte) -> void {
+    switch (inr->kind) {
+      case node_kind::n4:
+        remove_sorted(static_cast<node4 *>(inr), byte);
+        break;
+
+      case node_kind::n16:
+        remove_sorted(static_cast<node16 *>(inr), byte);
+        if (inr->count <= 3) { ref = rehome<node4>(inr); }
+        break;
+
+      case node_kind::n48: {
+        auto * nd = static_cast<node48 *>(inr);
+        nd->children[nd->index[byte] - 1] = nullptr;
+        nd->index[byte] = 0;
+        --nd->count;
+        if (nd->count <= 12) { ref = rehome<node16>(nd); }
+        break;
+      }
+
+      case node_kind::n256: {
+        auto * nd = static_cast<node256 *>(inr);
+        nd->children[byte] = nullptr;
+        --nd->count;
+        if (nd->count <= 36) { ref = rehome<node48>(nd); }
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+
+  static auto destroy(node * nd) -> void {
+    switch (nd->kind) {
+      case node_kind::leaf: delete static_cast<leaf *>(nd);    break;
+      case node_kind::n4:   delete static_cast<node4 *>(nd);   break;
+      case node_kind::n16:  delete static_cast<node16 *>(nd);  break;
+      case node_kind::n48:  delete static_cast<node48 *>(nd);  break;
+      case node_kind::n256: delete static_cast<node256 *>(nd); break;
+    }
+  }
+
+  static auto free_tree(node * nd) -> void {
+    if (nd->kind != node_kind::leaf) {
+      auto * inr = static_cast<inner *>(nd);
+      if (inr->terminal) { destroy(inr->terminal); }
+      for (auto [byte, child] = next_child(inr, 0); child;
+           std::tie(byte, child) = next_child(inr, byte + 1)) {
+        free_tree(child);
+      }
+    }
+    destroy(nd);
+  }
+
+  static auto min_leaf(node * nd) -> leaf * {
+    while (nd->kind != node_kind::leaf) {
+      auto * inr = static_cast<inner *>(nd);
+      if (inr->terminal) { return inr->terminal; }
+      nd = next_child(inr, 0).second;
+    }
+    return static_cast<leaf *>(nd);
+  }
+
+  static auto max_leaf(node * nd) -> leaf * {
+    while (nd->kind != node_kind::leaf) {
+      auto * inr = static_cast<inner *>(nd);
+      auto * child = prev_child(inr, 256).second;
+      if (child == nullptr) { return inr->terminal; }
+      nd = child;
+    }
+    return static_cast<leaf *>(nd);
+  }
+
+  static auto leaf_matches(leaf * lf, std::string_view key) -> bool {
+    return view(traits_type::encode(lf->value.first)) == key;
+  }
+
+  //  MARK: tree algorithms
+  auto find_leaf(std::string_view key) const -> leaf * {
+    auto * nd = root_;
+    std::size_t depth = 0;
+    while (nd) {
+      if (nd->kind == node_kind::leaf) {
+        auto * lf = static_cast<leaf *>(nd);
+        return leaf_matches(lf, key) ? lf : nullptr;
+      }
+      auto * inr = static_cast<inner *>(nd);
+      auto const plen = inr->prefix.size();
+      if (key.size() - depth < plen || key.compare(depth, plen, inr->prefix) != 0) {
+        return nullptr;
+      }
+      depth += plen;
+      if (depth == key.size()) { return inr->terminal; }
+      auto ** child = find_child(inr, byte_at(key, depth));
+      if (child == nullptr) { return nullptr; }
+      nd = *child;
+      ++depth;
+    }
+    return nullptr;
+  }
+
+  auto insert_leaf(node *& ref, std::string_view key, std::size_t depth, leaf * lf) -> void {
+    if (ref == nullptr) {
+      ref = lf;
+      link_before(&head_, lf);
+      return;
+    }
+
+    if (ref->kind == node_kind::leaf) {
+      // two keys share this slot: split on their common part
+      auto * old = static_cast<leaf *>(ref);
+      auto const okb = traits_type::encode(old->value.first);
+      auto const okey = view(okb);
+      auto ix = depth;
+      auto const lim = std::min(okey.size(), key.size());
+      while (ix < lim && okey[ix] == key[ix]) { ++ix; }
+
+      auto * nd = new node4;
+      nd->prefix.assign(key.substr(depth, ix - depth));
+      auto place = [nd, ix](std::string_view kk, leaf * ll) {
+        if (ix == kk.size()) { nd->terminal = ll; }
+        else { add_sorted(nd, byte_at(kk, ix), ll); }
+      };
+      place(okey, old);
+      place(key, lf);
+      ref = nd;
+      if (key < okey) { link_before(old, lf); }
+      else            { link_after(old, lf); }
+      return;
+    }
+
+    auto * inr = static_cast<inner *>(ref);
+    auto const rest = key.substr(depth);
+    auto const & pfx = inr->prefix;
+    std::size_t pos = 0;
+    while (pos < pfx.size() && pos < rest.size() && pfx[pos] == rest[pos]) { ++pos; }
+
+    if (pos < pfx.size()) {
+      // key leaves the compressed path part way: split the prefix
+      auto * nd = new node4;
+      nd->prefix.assign(pfx, 0, pos);
+      auto const byte = static_cast<std::uint8_t>(pfx[pos]);
+      inr->prefix.erase(0, pos + 1);
+      add_sorted(nd, byte, inr);
+      if (pos == rest.size()) {
+        nd->terminal = lf;
+        link_before(min_leaf(inr), lf);
+      }
+      else {
+        auto const kbyte = byte_at(rest, pos);
+        add_sorted(nd, kbyte, lf);
+        if (kbyte < byte) { link_before(min_leaf(inr), lf); }
+        else              { link_after(max_leaf(inr), lf); }
+      }
+      ref = nd;
+      return;
+    }
+
+    depth += pfx.size();
+    if (depth == key.size()) {
+      // shorter keys sort first: before everything below this node
+      link_before(min_leaf(inr), lf);
+      inr->terminal = lf;
+      return;
+    }
+
+    auto const byte = byte_at(key, depth);
+    if (auto ** child = find_child(inr, byte)) {
+      insert_leaf(*child, key, depth + 1, lf);
+      return;
+    }
+
+    if (auto * succ = next_child(inr, byte + 1u).second) {
+      link_before(min_leaf(succ), lf);
+    }
+    else if (auto * pred = prev_child(inr, byte).second) {
+      link_after(max_leaf(pred), lf);
+    }
+    else {
+      link_after(inr->terminal, lf);
+    }
+    add_child(ref, inr, byte, lf);
+  }
+
+  auto erase_leaf(node *& ref, std::string_view key, std::size_t depth) -> leaf * {
+    if (ref->kind == node_kind::leaf) {
+      auto * lf = static_cast<leaf *>(ref);
+      if (!leaf_matches(lf, key)) { return nullptr; }
+      ref = nullptr;
+      return lf;
+    }
+
+    auto * inr = static_cast<inner *>(ref);
+    auto const plen = inr->prefix.size();
+    if (key.size() - depth < plen || key.compare(depth, plen, inr->prefix) != 0) {
+      return nullptr;
+    }
+    depth += plen;
+
+    leaf * found = nullptr;
+    if (depth == key.size()) {
+      found = std::exchange(inr->terminal, nullptr);
+      if (found == nullptr) { return nullptr; }
+    }
+    else {
+      auto const byte = byte_at(key, depth);
+      auto ** child = find_child(inr, byte);
+      if (child == nullptr) { return nullptr; }
+      if ((*child)->kind != node_kind::leaf) {
+        return erase_leaf(*child, key, depth + 1);
+      }
+      found = static_cast<leaf *>(*child);
+      if (!leaf_matches(found, key)) { return nullptr; }
+      remove_child(ref, inr, byte);
+    }
+    compact(ref);
+    return found;
+  }
+
+  // restore the "at least two entries per inner node" invariant
+  static auto compact(node *& ref) -> void {
+    auto * inr = static_cast<inner *>(ref);
+    if (inr->count == 0) {
+      ref = inr->terminal;
+      destroy(inr);
+    }
+    else if (inr->count == 1 && inr->terminal == nullptr) {
+      auto [byte, child] = next_child(inr, 0);
+      if (child->kind != node_kind::leaf) {
+        auto * below = static_cast<inner *>(child);
+        auto merged = std::move(inr->prefix);
+        merged.push_back(static_cast<char>(byte));
+        merged += below->prefix;
+        below->prefix = std::move(merged);
+      }
+      ref = child;
+      destroy(inr);
+    }
+  }
+
+  // first leaf of the subtree whose key is >= key, nullptr if none
+  static auto lower_leaf(node * nd, std::string_view key, std::size_t depth) -> leaf * {
+    if (nd->kind == node_kind::leaf) {
+      auto * lf = static_cast<leaf *>(nd);
+      return view(traits_type::encode(lf->value.first)) >= key ? lf : nullptr;
+    }
+
+    auto * inr = static_cast<inner *>(nd);
+    for (std::size_t ix = 0; ix < inr->prefix.size(); ++ix) {
+      if (depth + ix == key.size()) { return min_leaf(inr); }
+      auto const pbyte = static_cast<std::uint8_t>(inr->prefix[ix]);
+      auto const kbyte = byte_at(key, depth + ix);
+      if (pbyte < kbyte) { return nullptr; }
+      if (pbyte > kbyte) { return min_leaf(inr); }
+    }
+    depth += inr->prefix.size();
+    if (depth == key.size()) { return min_leaf(inr); }
+
+    // the terminal (if any) is a proper prefix of key, so it is smaller
+    auto const byte = byte_at(key, depth);
+    if (auto ** child = find_child(inr, byte)) {
+      if (auto * lf = lower_leaf(*child, key, depth + 1)) { return lf; }
+    }
+    auto * succ = next_child(inr, byte + 1u).second;
+    return succ ? min_leaf(succ) : nullptr;
+  }
+
+  node *    root_ = nullptr;
+  size_type size_ = 0;
+  link      head_;
+};
+
+} /* namespace cmapart */
+
+#endif /* art_map_hpp */
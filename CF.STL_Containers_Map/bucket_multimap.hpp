@@ -0,0 +1,287 @@
+//
+//  bucket_multimap.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/container/multimap
+//  @see: https://en.cppreference.com/w/cpp/container/span
+//
+
+#ifndef bucket_multimap_hpp
+#define bucket_multimap_hpp
+
+#include <map>
+#include <vector>
+#include <span>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <iterator>
+#include <initializer_list>
+#include <type_traits>
+#include <cstddef>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapmv
+namespace cmapmv {
+
+/*
+ *  MARK: bucket_multimap
+ *  Ordered multi-value map: one tree node per distinct key, holding every
+ *  value of that key in a contiguous bucket (std::vector) in insertion
+ *  order.  Where std::multimap pays a node, with its three pointers and
+ *  colour, for each value, a key with d values here costs one node plus
+ *  d packed values, and equal_range() is a std::span over the bucket.
+ *  That pays off from about two values per key; with unique keys every
+ *  key costs a node plus a one-element vector, more than std::multimap.
+ *
+ *  Inserts remember nothing but are append-optimised all the same: a key
+ *  equal to the last key goes straight into the last bucket, a greater
+ *  one gets end() as its hint, so loading sorted (or time-ordered) data
+ *  never searches the tree.  Buckets are never empty; erasing the last
+ *  value of a key removes its node.  Inserting into a bucket may move
+ *  its values, invalidating spans, iterators and references to them.
+ */
+template <class Key, class T,
+          class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<Key const, T>>>
+class bucket_multimap {
+  using alloc_traits = std::allocator_traits<Allocator>;
+
+public:
+  using key_type       = Key;
+  using mapped_type    = T;
+  using value_type     = std::pair<Key, T>;
+  using size_type      = std::size_t;
+  using key_compare    = Compare;
+  using allocator_type = Allocator;
+  using bucket_type    = std::vector<T, typename alloc_traits::template rebind_alloc<T>>;
+  using map_type       = std::map<Key, bucket_type, Compare,
+    typename alloc_traits::template rebind_alloc<std::pair<Key const, bucket_type>>>;
+
+  //  MARK: iterator
+  // every (key, value) in key order, a bucket's values in insertion order
+  template <bool Const>
+  class basic_iterator {
+    friend class bucket_multimap;
+    using base_type = std::conditional_t<Const, typename map_type::const_iterator,
+                                                typename map_type::iterator>;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = bucket_multimap::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using reference = std::pair<Key const &, std::conditional_t<Const, T const &, T &>>;
+
+    struct pointer {
+      reference ref;
+      auto operator->() -> reference * { return &ref; }
+    };
+
+    basic_iterator() = default;
+    template <bool C = Const> requires C
+    basic_iterator(basic_iterator<false> const & other) : bucket_(other.bucket_), ix_(other.ix_) {}
+
+    auto operator*() const -> reference { return { bucket_->first, bucket_->second[ix_] }; }
+    auto operator->() const -> pointer { return { **this }; }
+
+    auto operator++() -> basic_iterator & {
+      if (++ix_ == bucket_->second.size()) { ++bucket_; ix_ = 0; }
+      return *this;
+    }
+    auto operator++(int) -> basic_iterator { auto tmp = *this; ++*this; return tmp; }
+    auto operator--() -> basic_iterator & {
+      if (ix_ == 0) { --bucket_; ix_ = bucket_->second.size(); }
+      --ix_;
+      return *this;
+    }
+    auto operator--(int) -> basic_iterator { auto tmp = *this; --*this; return tmp; }
+
+    friend bool operator==(basic_iterator const & lhs, basic_iterator const & rhs) {
+      return lhs.bucket_ == rhs.bucket_ && lhs.ix_ == rhs.ix_;
+    }
+
+    // the node of this key; bucket()->second is the whole bucket
+    auto bucket() const -> base_type { return bucket_; }
+
+  private:
+    basic_iterator(base_type bucket, size_type ix) : bucket_(bucket), ix_(ix) {}
+
+    base_type bucket_ {};
+    size_type ix_ = 0;
+    friend class basic_iterator<!Const>;
+  };
+
+  using iterator               = basic_iterator<false>;
+  using const_iterator         = basic_iterator<true>;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  //  MARK: construction
+  bucket_multimap() = default;
+
+  explicit bucket_multimap(Compare const & comp, Allocator const & alloc = Allocator())
+    : map_(comp, typename map_type::allocator_type(alloc)), alloc_(alloc) {}
+
+  bucket_multimap(std::initializer_list<value_type> init,
+                  Compare const & comp = Compare(), Allocator const & alloc = Allocator())
+    : bucket_multimap(comp, alloc) {
+    insert(init.begin(), init.end());
+  }
+
+  template <std::input_iterator It>
+  bucket_multimap(It first, It last, Compare const & comp = Compare(), Allocator const & alloc = Allocator())
+    : bucket_multimap(comp, alloc) {
+    insert(first, last);
+  }
+
+  //  MARK: iterators
+  auto begin() noexcept -> iterator { return { map_.begin(), 0 }; }
+  auto end() noexcept -> iterator { return { map_.end(), 0 }; }
+  auto begin() const noexcept -> const_iterator { return { map_.begin(), 0 }; }
+  auto end() const noexcept -> const_iterator { return { map_.end(), 0 }; }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+  auto rbegin() noexcept { return reverse_iterator(end()); }
+  auto rend() noexcept { return reverse_iterator(begin()); }
+  auto rbegin() const noexcept { return const_reverse_iterator(end()); }
+  auto rend() const noexcept { return const_reverse_iterator(begin()); }
+
+  //  MARK: capacity
+  [[nodiscard]] auto empty() const noexcept -> bool { return map_.empty(); }
+  auto size() const noexcept -> size_type { return size_; }            // values
+  auto key_count() const noexcept -> size_type { return map_.size(); } // distinct keys
+
+  auto buckets() const noexcept -> map_type const & { return map_; }
+  auto key_comp() const -> key_compare { return map_.key_comp(); }
+  auto get_allocator() const -> allocator_type { return alloc_; }
+
+  // drop the spare capacity of every bucket, e.g. once loading is done
+  auto shrink_to_fit() -> void {
+    for (auto & [key, bucket] : map_) { bucket.shrink_to_fit(); }
+  }
+
+  //  MARK: lookup
+  auto equal_range(Key const & key) -> std::span<T> {
+    auto it = map_.find(key);
+    return it == map_.end() ? std::span<T> {} : std::span<T>(it->second);
+  }
+  auto equal_range(Key const & key) const -> std::span<T const> {
+    auto it = map_.find(key);
+    return it == map_.end() ? std::span<T const> {} : std::span<T const>(it->second);
+  }
+
+  auto find(Key const & key) -> iterator { return { map_.find(key), 0 }; }
+  auto find(Key const & key) const -> const_iterator { return { map_.find(key), 0 }; }
+  auto lower_bound(Key const & key) -> iterator { return { map_.lower_bound(key), 0 }; }
+  auto lower_bound(Key const & key) const -> const_iterator { return { map_.lower_bound(key), 0 }; }
+  auto upper_bound(Key const & key) -> iterator { return { map_.upper_bound(key), 0 }; }
+  auto upper_bound(Key const & key) const -> const_iterator { return { map_.upper_bound(key), 0 }; }
+
+  auto contains(Key const & key) const -> bool { return map_.contains(key); }
+  auto count(Key const & key) const -> size_type {
+    auto it = map_.find(key);
+    return it == map_.end() ? 0 : it->second.size();
+  }
+
+  //  MARK: modifiers
+  // appends to the key's bucket; returns the new element.  If the value
+  //  throws, a bucket made for it is dropped again, so none is left empty
+  template <class ... Args>
+  auto emplace(Key const & key, Args && ... args) -> iterator {
+    auto node = bucket_for(key);
+    try {
+      node->second.emplace_back(std::forward<Args>(args) ...);
+    } catch (...) {
+      if (node->second.empty()) { map_.erase(node); }
+      throw;
+    }
+    ++size_;
+    return { node, node->second.size() - 1 };
+  }
+
+  auto insert(Key const & key, T const & value) -> iterator { return emplace(key, value); }
+  auto insert(Key const & key, T && value) -> iterator { return emplace(key, std::move(value)); }
+  auto insert(value_type const & value) -> iterator { return emplace(value.first, value.second); }
+
+  template <std::input_iterator It>
+  auto insert(It first, It last) -> void {
+    for (; first != last; ++first) { emplace(first->first, first->second); }
+  }
+
+  // every value of key
+  auto erase(Key const & key) -> size_type {
+    auto it = map_.find(key);
+    if (it == map_.end()) { return 0; }
+    auto const erased = it->second.size();
+    map_.erase(it);
+    size_ -= erased;
+    return erased;
+  }
+
+  // one value; returns the element after it
+  auto erase(const_iterator pos) -> iterator {
+    auto node = map_.erase(pos.bucket_, pos.bucket_);    // const_iterator -> iterator
+    auto & bucket = node->second;
+    bucket.erase(bucket.begin() + static_cast<std::ptrdiff_t>(pos.ix_));
+    --size_;
+    if (bucket.empty()) { return { map_.erase(node), 0 }; }
+    if (pos.ix_ == bucket.size()) { return { std::next(node), 0 }; }
+    return { node, pos.ix_ };
+  }
+
+  auto clear() noexcept -> void {
+    map_.clear();
+    size_ = 0;
+  }
+
+  auto swap(bucket_multimap & other) noexcept -> void {
+    map_.swap(other.map_);
+    std::swap(size_, other.size_);
+    std::swap(alloc_, other.alloc_);
+  }
+
+  // erase every (key, value) for which pred holds; buckets keep their order
+  template <class Pred>
+  friend auto erase_if(bucket_multimap & mmap, Pred pred) -> size_type {
+    size_type erased = 0;
+    for (auto node = mmap.map_.begin(); node != mmap.map_.end(); ) {
+      auto & bucket = node->second;
+      erased += std::erase_if(bucket, [&](T const & value) {
+        return pred(std::pair<Key const &, T const &>(node->first, value));
+      });
+      node = bucket.empty() ? mmap.map_.erase(node) : std::next(node);
+    }
+    mmap.size_ -= erased;
+    return erased;
+  }
+
+  friend auto operator==(bucket_multimap const & lhs, bucket_multimap const & rhs) -> bool {
+    return lhs.size_ == rhs.size_ && lhs.map_ == rhs.map_;
+  }
+
+private:
+  // the key's node, created if need be; a trailing key skips the search
+  auto bucket_for(Key const & key) -> typename map_type::iterator {
+    if (!map_.empty()) {
+      auto last = std::prev(map_.end());
+      auto const & comp = map_.key_comp();
+      if (!comp(last->first, key)) {
+        if (!comp(key, last->first)) { return last; }        // same key as the last one
+        return map_.try_emplace(key, bucket_alloc()).first;  // somewhere before it
+      }
+    }
+    return map_.try_emplace(map_.end(), key, bucket_alloc());
+  }
+
+  auto bucket_alloc() const { return typename bucket_type::allocator_type(alloc_); }
+
+  map_type  map_;
+  size_type size_ = 0;
+  [[no_unique_address]] Allocator alloc_ {};
+};
+
+} /* namespace cmapmv */
+
+#endif /* bucket_multimap_hpp */
@@ -0,0 +1,547 @@
+//
+//  cache_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/container/map/find (overloads 3, 4: transparent)
+//  @see: https://en.cppreference.com/w/cpp/container/map/extract
+//  @see: https://arxiv.org/abs/1512.00727 (TinyLFU: A Highly Efficient Cache Admission Policy)
+//  @see: https://github.com/ben-manes/caffeine/wiki/Efficiency
+//
+
+#ifndef cache_map_hpp
+#define cache_map_hpp
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
+#include <ostream>
+#include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <type_traits>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+#include "recycling_map.hpp"
+#include "fingerprint_map.hpp"
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapcache
+namespace cmapcache {
+
+/*
+ *  MARK: policies
+ *    lru       - one recency list; the least recently used entry goes.
+ *    w_tinylfu - a small LRU window (1% of the budget) in front of a
+ *                segmented LRU (probation, then protected at 80%).  An
+ *                entry leaving the window is admitted to the main area
+ *                only if a frequency sketch rates it above the entry it
+ *                would evict, so a scan of one-off keys cannot flush the
+ *                popular ones.  Hash hashes Key (std::hash<Key> for
+ *                void; strings also as string_view), and other lookup
+ *                types when it accepts them; misses it cannot hash
+ *                are not counted.
+ */
+struct lru {};
+
+template <class Hash = void>
+struct w_tinylfu {};
+
+/*
+ *  MARK: element_weigher
+ *  The bytes an entry is charged besides its node and links, which the
+ *  cache adds itself: sizeof key and value.  Pass a weigher that also
+ *  counts what they own, e.g. key.capacity() + value.capacity() for
+ *  strings, to hold the budget to real memory.
+ */
+template <class Key, class T>
+struct element_weigher {
+  constexpr auto operator()(Key const &, T const &) const noexcept -> std::size_t {
+    return sizeof(Key) + sizeof(T);
+  }
+};
+
+/*
+ *  MARK: cache_options
+ *  Either bound may be 0, meaning none; at least one should be set.
+ */
+struct cache_options {
+  std::size_t max_entries = 0;
+  std::size_t max_bytes   = 0;
+};
+
+/*
+ *  MARK: cache_stats
+ *    admitted  - entries that made it past the window (every insert,
+ *                under lru);
+ *    rejected  - entries dropped on the way in: lost the frequency
+ *                contest, or larger than the whole budget;
+ *    evictions - entries removed for space, contest losers included.
+ */
+struct cache_stats {
+  std::uint64_t hits          = 0;
+  std::uint64_t misses        = 0;
+  std::uint64_t inserts       = 0;
+  std::uint64_t updates       = 0;
+  std::uint64_t admitted      = 0;
+  std::uint64_t rejected      = 0;
+  std::uint64_t evictions     = 0;
+  std::uint64_t evicted_bytes = 0;
+
+  auto hit_rate() const noexcept -> double {
+    auto const lookups = hits + misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+  }
+
+  friend auto operator<<(std::ostream & os, cache_stats const & stats) -> std::ostream & {
+    return os << "hits " << stats.hits << ", misses " << stats.misses
+              << " (" << std::fixed << std::setprecision(1) << stats.hit_rate() * 100.0 << "%)"
+              << std::defaultfloat << std::setprecision(6)
+              << ", inserts " << stats.inserts << ", updates " << stats.updates
+              << ", admitted " << stats.admitted << ", rejected " << stats.rejected
+              << ", evicted " << stats.evictions << " (" << stats.evicted_bytes << " bytes)";
+  }
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: frequency_sketch
+ *  Count-min sketch of 4-bit counters, four rows, 16 counters to a
+ *  64-bit word; sized once, for the cache's capacity.  After 10 x width
+ *  increments every counter is halved, so old popularity fades.
+ */
+class frequency_sketch {
+public:
+  explicit frequency_sketch(std::size_t capacity)
+    : table_(std::bit_ceil(std::clamp<std::size_t>(capacity, 16, std::size_t { 1 } << 24))),
+      sample_limit_(10 * table_.size()) {}
+
+  auto frequency(std::uint64_t hash) const noexcept -> unsigned {
+    unsigned least = 15;
+    for (unsigned row = 0; row < rows; ++row) {
+      auto const [index, shift] = slot(hash, row);
+      least = std::min(least, static_cast<unsigned>(table_[index] >> shift & 0xf));
+    }
+    return least;
+  }
+
+  auto increment(std::uint64_t hash) noexcept -> void {
+    auto added = false;
+    for (unsigned row = 0; row < rows; ++row) {
+      auto const [index, shift] = slot(hash, row);
+      if ((table_[index] >> shift & 0xf) < 15) {
+        table_[index] += std::uint64_t { 1 } << shift;
+        added = true;
+      }
+    }
+    if (added && ++samples_ >= sample_limit_) { age(); }
+  }
+
+  auto clear() noexcept -> void {
+    std::fill(table_.begin(), table_.end(), std::uint64_t { 0 });
+    samples_ = 0;
+  }
+
+private:
+  static constexpr unsigned rows = 4;
+
+  // row r owns counters 4r .. 4r+3 of the word its hash picks
+  auto slot(std::uint64_t hash, unsigned row) const noexcept -> std::pair<std::size_t, unsigned> {
+    auto const bits = cmapfp::mix64(hash + row * 0x9e3779b97f4a7c15ull);
+    return { static_cast<std::size_t>(bits & (table_.size() - 1)),
+             static_cast<unsigned>((row * 4 + (bits >> 62)) * 4) };
+  }
+
+  auto age() noexcept -> void {
+    for (auto & word : table_) { word = word >> 1 & 0x7777'7777'7777'7777ull; }
+    samples_ /= 2;
+  }
+
+  std::vector<std::uint64_t> table_;
+  std::size_t                sample_limit_;
+  std::size_t                samples_ = 0;
+};
+
+namespace detail {
+
+// std::hash<Key>; for std::string also string_view and char const *
+template <class Key>
+struct default_hash : std::hash<Key> {};
+
+template <>
+struct default_hash<std::string> {
+  auto operator()(std::string_view text) const noexcept -> std::size_t {
+    return std::hash<std::string_view> {}(text);
+  }
+};
+
+template <class Policy, class Key>
+struct policy_traits {
+  static constexpr bool tinylfu = false;
+  struct hash_type {};
+};
+
+template <class Hash, class Key>
+struct policy_traits<w_tinylfu<Hash>, Key> {
+  static constexpr bool tinylfu = true;
+  using hash_type = std::conditional_t<std::is_void_v<Hash>, default_hash<Key>, Hash>;
+};
+
+} /* namespace detail */
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: cache_map
+ *  Bounded map for lookup caches, replacing a std::map trimmed by hand.
+ *  Entries live in a std::map, so lookups are the map's O(log n) and
+ *  take any key the Compare accepts (std::less<> by default: a LightKey
+ *  finds a FatKey entry).  The recency lists run through the entries
+ *  themselves, so picking a victim and every list move are O(1) and
+ *  allocate nothing; the sketch is allocated once.  Evicted nodes are
+ *  kept in a small cmaprec::node_pool and rewritten by later inserts,
+ *  so a full cache under churn stops calling the allocator too.
+ *
+ *  find() counts a hit or miss and refreshes the entry; peek() and
+ *  contains() do neither.  A pointer from find() or peek() is valid
+ *  until the next insert or erase.  Not thread-safe.
+ */
+template <class Key, class T,
+          class Compare = std::less<>,
+          class Policy = w_tinylfu<>,
+          class Weigher = element_weigher<Key, T>>
+class cache_map {
+  struct entry;
+  using node = std::pair<Key const, entry>;
+
+  enum class segment : std::uint8_t { window, probation, protect, };
+
+  struct entry {
+    T           value;
+    std::size_t bytes = 0;
+    node *      prev  = nullptr;
+    node *      next  = nullptr;
+    segment     where = segment::window;
+  };
+
+  using traits    = detail::policy_traits<Policy, Key>;
+  using hash_type = typename traits::hash_type;
+
+public:
+  using key_type    = Key;
+  using mapped_type = T;
+  using size_type   = std::size_t;
+  using key_compare = Compare;
+  using map_type    = std::map<Key, entry, Compare>;
+
+  // what each entry costs on top of the weigher's bytes: tree links and colour, plus ours
+  static constexpr size_type node_overhead = 4 * sizeof(void *) + sizeof(entry) - sizeof(T);
+
+  explicit cache_map(cache_options const & opts, Compare const & comp = Compare(), Weigher weigher = Weigher())
+    : map_(comp), weigher_(std::move(weigher)), opts_(opts),
+      total_ { bound(opts.max_entries), bound(opts.max_bytes) },
+      sketch_(traits::tinylfu ? sketch_width(opts) : 0) {
+    if constexpr (traits::tinylfu) {
+      window_  = { std::max<size_type>(total_.entries / 100, 1), std::max<size_type>(total_.bytes / 100, 1) };
+      main_    = { total_.entries - window_.entries, total_.bytes - window_.bytes };
+      protect_ = { four_fifths(main_.entries), four_fifths(main_.bytes) };
+    }
+    else {
+      window_ = total_;
+    }
+  }
+
+  cache_map(cache_map const &) = delete;
+  auto operator=(cache_map const &) -> cache_map & = delete;
+
+  //  MARK: lookup
+  template <class K>
+  auto find(K const & key) -> T * {
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      ++stats_.misses;
+      if constexpr (traits::tinylfu) {
+        if constexpr (std::is_invocable_v<hash_type const &, K const &>) { record(key); }
+      }
+      return nullptr;
+    }
+    ++stats_.hits;
+    auto * nd = &*it;
+    if constexpr (traits::tinylfu) { record(nd->first); }
+    touch(nd);
+    return &nd->second.value;
+  }
+
+  template <class K>
+  auto peek(K const & key) const -> T const * {
+    auto it = map_.find(key);
+    return it == map_.end() ? nullptr : &it->second.value;
+  }
+
+  template <class K>
+  auto contains(K const & key) const -> bool { return map_.contains(key); }
+
+  // fn(key, value) in key order; nothing is refreshed
+  template <class Fn>
+  auto for_each(Fn fn) const -> void {
+    for (auto const & [key, item] : map_) { fn(key, item.value); }
+  }
+
+  [[nodiscard]] auto empty() const noexcept { return map_.empty(); }
+  auto size() const noexcept -> size_type { return map_.size(); }
+  auto bytes() const noexcept -> size_type {
+    return queues_[0].bytes + queues_[1].bytes + queues_[2].bytes;
+  }
+  auto options() const noexcept -> cache_options const & { return opts_; }
+  auto stats() const noexcept -> cache_stats const & { return stats_; }
+  auto reset_stats() noexcept -> void { stats_ = {}; }
+
+  //  MARK: modifiers
+  // true if a new entry was placed; false for an update, or for an
+  //  entry larger than the whole budget (counted as rejected)
+  template <class M>
+  auto insert_or_assign(Key const & key, M && obj) -> bool {
+    auto pos = map_.lower_bound(key);
+    if (pos != map_.end() && !map_.key_comp()(key, pos->first)) {
+      auto * nd = &*pos;
+      nd->second.value = std::forward<M>(obj);
+      reweigh(nd);
+      ++stats_.updates;
+      if constexpr (traits::tinylfu) { record(key); }
+      touch(nd);
+      evict_over();
+      return false;
+    }
+    return place(pos, key, std::forward<M>(obj));
+  }
+
+  // true if a new entry was placed; an existing one is refreshed, not assigned
+  template <class ... Args>
+  auto try_emplace(Key const & key, Args && ... args) -> bool {
+    auto pos = map_.lower_bound(key);
+    if (pos != map_.end() && !map_.key_comp()(key, pos->first)) {
+      if constexpr (traits::tinylfu) { record(key); }
+      touch(&*pos);
+      return false;
+    }
+    return place(pos, key, std::forward<Args>(args) ...);
+  }
+
+  template <class K>
+  auto erase(K const & key) -> size_type {
+    auto it = map_.find(key);
+    if (it == map_.end()) { return 0; }
+    unlink(&*it);
+    recycle(map_.extract(it));
+    return 1;
+  }
+
+  auto clear() -> void {
+    map_.clear();
+    queues_ = {};
+  }
+
+private:
+  struct budget {
+    size_type entries = 0;
+    size_type bytes   = 0;
+  };
+
+  static constexpr auto bound(size_type limit) noexcept -> size_type {
+    return limit == 0 ? std::numeric_limits<size_type>::max() : limit;
+  }
+
+  // the protected share of the main area, never 0 while there is room
+  //  for 2 (else every promotion is demoted again); multiplied first,
+  //  unless that would overflow an unbounded limit
+  static constexpr auto four_fifths(size_type limit) noexcept -> size_type {
+    auto const share = limit > std::numeric_limits<size_type>::max() / 4 ? limit / 5 * 4 : limit * 4 / 5;
+    return limit > 1 ? std::max<size_type>(share, 1) : share;
+  }
+
+  // one counter row slot per entry the cache can hold
+  static auto sketch_width(cache_options const & opts) -> size_type {
+    if (opts.max_entries != 0) { return opts.max_entries; }
+    return opts.max_bytes / (node_overhead + sizeof(Key));
+  }
+
+  static constexpr auto recyclable = std::is_move_assignable_v<Key> && std::is_move_assignable_v<T>;
+
+  //  MARK: queues
+  struct queue {
+    node *    head    = nullptr;   // most recent
+    node *    tail    = nullptr;   // next to go
+    size_type entries = 0;
+    size_type bytes   = 0;
+  };
+
+  auto queue_of(node const * nd) noexcept -> queue & {
+    return queues_[static_cast<std::size_t>(nd->second.where)];
+  }
+
+  auto link_front(segment where, node * nd) noexcept -> void {
+    auto & q = queues_[static_cast<std::size_t>(where)];
+    nd->second.where = where;
+    nd->second.prev  = nullptr;
+    nd->second.next  = q.head;
+    if (q.head) { q.head->second.prev = nd; } else { q.tail = nd; }
+    q.head = nd;
+    ++q.entries;
+    q.bytes += nd->second.bytes;
+  }
+
+  auto unlink(node * nd) noexcept -> void {
+    auto & q = queue_of(nd);
+    auto & item = nd->second;
+    if (item.prev) { item.prev->second.next = item.next; } else { q.head = item.next; }
+    if (item.next) { item.next->second.prev = item.prev; } else { q.tail = item.prev; }
+    --q.entries;
+    q.bytes -= item.bytes;
+  }
+
+  static auto fits(queue const & q, budget const & limit, size_type entries = 0, size_type bytes = 0) noexcept -> bool {
+    return q.entries + entries <= limit.entries && q.bytes + bytes <= limit.bytes;
+  }
+
+  auto main_queue() const noexcept -> queue {
+    auto const & probation = queues_[1];
+    auto const & protect   = queues_[2];
+    return { nullptr, nullptr, probation.entries + protect.entries, probation.bytes + protect.bytes };
+  }
+
+  //  MARK: policy
+  auto touch(node * nd) noexcept -> void {
+    auto const where = nd->second.where;
+    unlink(nd);
+    if (where == segment::probation) {
+      link_front(segment::protect, nd);
+      while (!fits(queues_[2], protect_)) {
+        auto * demoted = queues_[2].tail;
+        unlink(demoted);
+        link_front(segment::probation, demoted);
+      }
+    }
+    else {
+      link_front(where, nd);
+    }
+  }
+
+  template <class K>
+  auto record(K const & key) noexcept -> void {
+    sketch_.increment(static_cast<std::uint64_t>(hash_(key)));
+  }
+
+  auto frequency(node const * nd) const noexcept -> unsigned {
+    return sketch_.frequency(static_cast<std::uint64_t>(hash_(nd->first)));
+  }
+
+  auto victim() const noexcept -> node * {
+    return queues_[1].tail ? queues_[1].tail : queues_[2].tail;
+  }
+
+  // back within budget: the window spills into the main area, whose
+  //  victims are contested by frequency
+  auto evict_over() -> void {
+    if constexpr (!traits::tinylfu) {
+      while (queues_[0].tail && !fits(queues_[0], window_)) { evict(queues_[0].tail); }
+    }
+    else {
+      while (queues_[0].tail && !fits(queues_[0], window_)) {
+        auto * candidate = queues_[0].tail;
+        auto admit = true;
+        while (!fits(main_queue(), main_, 1, candidate->second.bytes)) {
+          auto * loser = victim();
+          if (!loser || frequency(candidate) <= frequency(loser)) { admit = false; break; }
+          evict(loser);
+        }
+        if (admit) {
+          unlink(candidate);
+          link_front(segment::probation, candidate);
+          ++stats_.admitted;
+        }
+        else {
+          evict(candidate);
+          ++stats_.rejected;
+        }
+      }
+      // updates may have grown main area entries
+      while (victim() && !fits(main_queue(), main_)) { evict(victim()); }
+    }
+  }
+
+  auto evict(node * nd) -> void {
+    ++stats_.evictions;
+    stats_.evicted_bytes += nd->second.bytes;
+    unlink(nd);
+    recycle(map_.extract(nd->first));
+  }
+
+  auto recycle(typename map_type::node_type && nh) -> void {
+    if constexpr (recyclable) { pool_.give(std::move(nh)); }
+  }
+
+  auto reweigh(node * nd) -> void {
+    auto & q = queue_of(nd);
+    q.bytes -= nd->second.bytes;
+    nd->second.bytes = charge(nd->first, nd->second.value);
+    q.bytes += nd->second.bytes;
+  }
+
+  auto charge(Key const & key, T const & value) const -> size_type {
+    return node_overhead + weigher_(key, value);
+  }
+
+  // a new entry at pos: into the window (the only list, under lru)
+  template <class ... Args>
+  auto place(typename map_type::iterator pos, Key const & key, Args && ... args) -> bool {
+    if constexpr (traits::tinylfu) { record(key); }
+    auto it = map_.end();
+    if constexpr (recyclable) {
+      if (auto nh = pool_.take(); !nh.empty()) {
+        nh.key() = key;
+        nh.mapped().value = T(std::forward<Args>(args) ...);
+        it = map_.insert(pos, std::move(nh));
+      }
+    }
+    if (it == map_.end()) {
+      it = map_.emplace_hint(pos, std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(entry { T(std::forward<Args>(args) ...) }));
+    }
+    auto * nd = &*it;
+    nd->second.bytes = charge(nd->first, nd->second.value);
+
+    if (nd->second.bytes > total_.bytes) {
+      ++stats_.rejected;
+      recycle(map_.extract(it));
+      return false;
+    }
+    ++stats_.inserts;
+    if constexpr (!traits::tinylfu) { ++stats_.admitted; }
+    link_front(segment::window, nd);
+    evict_over();
+    return true;
+  }
+
+  map_type                       map_;
+  [[no_unique_address]] Weigher   weigher_;
+  [[no_unique_address]] hash_type hash_;
+  cache_options                  opts_;
+  budget                         total_;
+  budget                         window_;
+  budget                         main_;
+  budget                         protect_;
+  std::array<queue, 3>           queues_ {};
+  frequency_sketch               sketch_;
+  cmaprec::node_pool<map_type>   pool_ { 16 };
+  cache_stats                    stats_;
+};
+
+} /* namespace cmapcache */
+
+#endif /* cache_map_hpp */
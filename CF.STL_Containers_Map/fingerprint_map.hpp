@@ -0,0 +1,244 @@
+//
+//  fingerprint_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/container/map/operator_cmp
+//  @see: https://prng.di.unimi.it/splitmix64.c
+//
+
+#ifndef fingerprint_map_hpp
+#define fingerprint_map_hpp
+
+#include <map>
+#include <utility>
+#include <functional>
+#include <algorithm>
+#include <compare>
+#include <initializer_list>
+#include <iterator>
+#include <cstddef>
+#include <cstdint>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapfp
+namespace cmapfp {
+
+// splitmix64 finaliser: spreads std::hash's often-identity output
+constexpr
+auto mix64(std::uint64_t bits) noexcept -> std::uint64_t {
+  bits ^= bits >> 30; bits *= 0xbf58476d1ce4e5b9ull;
+  bits ^= bits >> 27; bits *= 0x94d049bb133111ebull;
+  bits ^= bits >> 31;
+  return bits;
+}
+
+/*
+ *  MARK: element_hash
+ *  Hash of one key/value pair.  The map's fingerprint is the sum (mod
+ *  2^64) of these, which does not depend on insertion order and can be
+ *  undone on erase by subtraction.
+ */
+template <class Key, class T>
+struct element_hash {
+  auto operator()(Key const & key, T const & value) const -> std::uint64_t {
+    auto const hk = mix64(static_cast<std::uint64_t>(std::hash<Key> {}(key)));
+    auto const hv = static_cast<std::uint64_t>(std::hash<T> {}(value));
+    return mix64(hk ^ (hv + 0x9e3779b97f4a7c15ull + (hk << 6) + (hk >> 2)));
+  }
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: fingerprinted_map
+ *  std::map wrapper that keeps an order-independent fingerprint of its
+ *  contents current on every insert, assignment and erase.  Maps whose
+ *  sizes or fingerprints differ compare unequal in O(1); only a
+ *  fingerprint match pays for the element-by-element scan, which keeps
+ *  == exact.  Mapped values are reachable read-only; change them through
+ *  insert_or_assign() or update() so the fingerprint can follow.
+ */
+template <class Key, class T,
+          class Compare = std::less<Key>,
+          class Hash = element_hash<Key, T>>
+class fingerprinted_map {
+public:
+  using map_type       = std::map<Key, T, Compare>;
+  using key_type       = Key;
+  using mapped_type    = T;
+  using value_type     = typename map_type::value_type;
+  using size_type      = typename map_type::size_type;
+  using key_compare    = Compare;
+  using iterator       = typename map_type::const_iterator;
+  using const_iterator = typename map_type::const_iterator;
+  using const_reverse_iterator = typename map_type::const_reverse_iterator;
+  using fingerprint_type = std::uint64_t;
+
+  fingerprinted_map() = default;
+
+  fingerprinted_map(std::initializer_list<value_type> init) {
+    insert(init.begin(), init.end());
+  }
+
+  template <std::input_iterator It>
+  fingerprinted_map(It first, It last) { insert(first, last); }
+
+  // a moved-from map is left empty, with the empty map's fingerprint
+  fingerprinted_map(fingerprinted_map const &) = default;
+  fingerprinted_map(fingerprinted_map && other) noexcept
+    : map_(std::move(other.map_)), print_(std::exchange(other.print_, 0)), hash_(other.hash_) {
+    other.map_.clear();
+  }
+
+  auto operator=(fingerprinted_map const &) -> fingerprinted_map & = default;
+  auto operator=(fingerprinted_map && other) noexcept -> fingerprinted_map & {
+    if (this != &other) {
+      map_ = std::move(other.map_);
+      other.map_.clear();
+      print_ = std::exchange(other.print_, 0);
+    }
+    return *this;
+  }
+
+  //  MARK: read-only access
+  auto begin()   const noexcept { return map_.cbegin(); }
+  auto end()     const noexcept { return map_.cend(); }
+  auto cbegin()  const noexcept { return map_.cbegin(); }
+  auto cend()    const noexcept { return map_.cend(); }
+  auto rbegin()  const noexcept { return map_.crbegin(); }
+  auto rend()    const noexcept { return map_.crend(); }
+  auto crbegin() const noexcept { return map_.crbegin(); }
+  auto crend()   const noexcept { return map_.crend(); }
+
+  [[nodiscard]] auto empty() const noexcept { return map_.empty(); }
+  auto size() const noexcept { return map_.size(); }
+
+  auto find(key_type const & key)        const { return map_.find(key); }
+  auto contains(key_type const & key)    const { return map_.contains(key); }
+  auto count(key_type const & key)       const { return map_.count(key); }
+  auto at(key_type const & key)          const -> mapped_type const & { return map_.at(key); }
+  auto lower_bound(key_type const & key) const { return map_.lower_bound(key); }
+  auto upper_bound(key_type const & key) const { return map_.upper_bound(key); }
+  auto equal_range(key_type const & key) const { return map_.equal_range(key); }
+  auto key_comp() const { return map_.key_comp(); }
+
+  auto fingerprint() const noexcept -> fingerprint_type { return print_; }
+  auto base() const noexcept -> map_type const & { return map_; }
+
+  //  MARK: modifiers
+  template <class ... Args>
+  auto emplace(Args && ... args) -> std::pair<const_iterator, bool> {
+    auto const result = map_.emplace(std::forward<Args>(args) ...);
+    if (result.second) { add(*result.first); }
+    return result;
+  }
+
+  template <class ... Args>
+  auto try_emplace(key_type const & key, Args && ... args)
+  -> std::pair<const_iterator, bool> {
+    auto const result = map_.try_emplace(key, std::forward<Args>(args) ...);
+    if (result.second) { add(*result.first); }
+    return result;
+  }
+
+  auto insert(value_type const & value) -> std::pair<const_iterator, bool> {
+    return emplace(value);
+  }
+
+  template <std::input_iterator It>
+  auto insert(It first, It last) -> void {
+    for (; first != last; ++first) { emplace(*first); }
+  }
+
+  template <class M>
+  auto insert_or_assign(key_type const & key, M && obj) -> std::pair<const_iterator, bool> {
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+      return emplace(key, std::forward<M>(obj));
+    }
+    rehash(it, [&](mapped_type & mapped) { mapped = std::forward<M>(obj); });
+    return { it, false };
+  }
+
+  /*
+   *  Apply fn(mapped_type &) to the value at key, re-fingerprinting it.
+   *  Returns false (and does nothing) when key is absent.  If fn throws,
+   *  the fingerprint counts whatever it left in the value.
+   */
+  template <class Fn>
+  auto update(key_type const & key, Fn && fn) -> bool {
+    auto it = map_.find(key);
+    if (it == map_.end()) { return false; }
+    rehash(it, std::forward<Fn>(fn));
+    return true;
+  }
+
+  auto erase(key_type const & key) -> size_type {
+    auto it = map_.find(key);
+    if (it == map_.end()) { return 0; }
+    erase(it);
+    return 1;
+  }
+
+  auto erase(const_iterator pos) -> const_iterator {
+    remove(*pos);
+    return map_.erase(pos);
+  }
+
+  auto clear() noexcept -> void {
+    map_.clear();
+    print_ = 0;
+  }
+
+  auto swap(fingerprinted_map & other) noexcept -> void {
+    map_.swap(other.map_);
+    std::swap(print_, other.print_);
+  }
+
+  friend auto swap(fingerprinted_map & lhs, fingerprinted_map & rhs) noexcept -> void {
+    lhs.swap(rhs);
+  }
+
+  //  MARK: comparison
+  friend auto operator==(fingerprinted_map const & lhs, fingerprinted_map const & rhs)
+  -> bool {
+    if (lhs.size() != rhs.size() || lhs.print_ != rhs.print_) { return false; }
+    return lhs.map_ == rhs.map_;
+  }
+
+  // std::map has no contiguous storage to hand to memcmp; the ordering
+  //  scan stops at the first differing element, and equal fingerprints
+  //  are only taken as a hint, never as proof.
+  friend auto operator<=>(fingerprinted_map const & lhs, fingerprinted_map const & rhs) {
+    return lhs.map_ <=> rhs.map_;
+  }
+
+private:
+  auto hash_of(value_type const & value) const -> fingerprint_type {
+    return hash_(value.first, value.second);
+  }
+  auto add(value_type const & value) -> void { print_ += hash_of(value); }
+  auto remove(value_type const & value) -> void { print_ -= hash_of(value); }
+
+  // mutate the value in place; the old hash is swapped for the new one
+  //  when mutate returns or throws, so the print never loses the element
+  template <class Mutate>
+  auto rehash(typename map_type::iterator it, Mutate && mutate) -> void {
+    struct resync {
+      fingerprinted_map & self;
+      value_type const &  value;
+      fingerprint_type    before;
+      ~resync() { self.print_ += self.hash_of(value) - before; }
+    } sync { *this, *it, hash_of(*it) };
+    std::invoke(std::forward<Mutate>(mutate), it->second);
+  }
+
+  map_type         map_;
+  fingerprint_type print_ = 0;
+  [[no_unique_address]] Hash hash_;
+};
+
+} /* namespace cmapfp */
+
+#endif /* fingerprint_map_hpp */
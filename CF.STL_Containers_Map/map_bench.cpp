@@ -0,0 +1,1051 @@
+//
+//  map_bench.cpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  Timings for the containers and algorithms exercised in maps.cpp.
+//  usage: map_bench [nof_elements] [--json file]
+//  --json also writes every timing, with the build flavor, to file.
+//
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <tuple>
+#include <random>
+#include <chrono>
+#include <map>
+#include <functional>
+#include <vector>
+#include <list>
+#include <thread>
+#include <shared_mutex>
+#include <optional>
+#include <fstream>
+#include <filesystem>
+#include <charconv>
+#include <cmath>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+#include "map_parallel.hpp"
+#include "map_setops.hpp"
+#include "timeseries_map.hpp"
+#include "persistent_map.hpp"
+#include "rcu_map.hpp"
+#include "recycling_map.hpp"
+#include "map_loader.hpp"
+#include "map_traverse.hpp"
+#include "map_views.hpp"
+#include "small_map.hpp"
+#include "bucket_multimap.hpp"
+#include "map_instrument.hpp"
+#include "order_statistic_map.hpp"
+#include "fast_less.hpp"
+#include "cache_map.hpp"
+
+//  CMAP_BUILD_FLAVOR names the build (set by CMakeLists.txt) in --json output.
+#ifndef CMAP_BUILD_FLAVOR
+#define CMAP_BUILD_FLAVOR "default"
+#endif
+
+using namespace std::literals::string_literals;
+using namespace std::literals::string_view_literals;
+
+//  MARK: - Definitions
+
+//  MARK: - Local Constants.
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace konst
+namespace konst {
+
+auto delimiter(char const dc = '-', size_t sl = 80) -> std::string const {
+  auto const dlm = std::string(sl, dc);
+  return dlm;
+}
+
+static
+auto const dlm = delimiter();
+
+static
+auto const dot = delimiter('.');
+
+} /* namespace konst */
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace bench
+namespace bench {
+
+// keep a result alive so the timed work is not optimised away
+inline std::size_t volatile sink = 0;
+
+/*
+ *  MARK: timeit()
+ *  Run fn once; print and return the wall-clock time in milliseconds.
+ *  fn returns a size (elements produced, found, ...) that is printed
+ *  alongside so different strategies can be checked against each other.
+ *  Each run is also kept in records, under the current group, for
+ *  write_json().
+ */
+struct record {
+  std::string group;
+  std::string what;
+  double      ms;
+  std::size_t result;
+};
+
+inline std::string         group;     // the B_ function running
+inline std::vector<record> records;   // every timeit() so far
+
+template <class Fn>
+auto timeit(std::string_view what, Fn && fn) -> double {
+  auto start = std::chrono::steady_clock::now();
+  auto const result = static_cast<std::size_t>(fn());
+  auto stop = std::chrono::steady_clock::now();
+  sink = result;
+  std::chrono::duration<double, std::milli> time = stop - start;
+  std::cout << std::right << std::fixed << std::setprecision(2) << std::setw(10)
+            << time.count() << "  ms for "s << std::left << std::setw(44) << what
+            << " -> "s << result << '\n';
+  records.push_back({ group, std::string(what), time.count(), result });
+  return time.count();
+}
+
+/*
+ *  MARK: write_json()
+ *  records as JSON, with the build they came from, so runs of differently
+ *  built binaries (plain, native, LTO, PGO) can be compared by script.
+ */
+inline auto quoted(std::string_view text) -> std::string {
+  auto out = "\""s;
+  for (auto ch : text) {
+    if (ch == '"' || ch == '\\') { out += '\\'; }
+    out += ch;
+  }
+  return out + '"';
+}
+
+inline auto write_json(std::ostream & os, std::size_t nof_elements) -> void {
+#if defined(__GNUC__) && !defined(__clang__)
+  auto const compiler = std::string_view("GCC " __VERSION__);
+#elif defined(__VERSION__)
+  auto const compiler = std::string_view(__VERSION__);
+#else
+  auto const compiler = std::string_view("unknown");
+#endif
+  os << "{\n"s
+     << "  \"flavor\": "s << quoted(CMAP_BUILD_FLAVOR) << ",\n"s
+     << "  \"compiler\": "s << quoted(compiler) << ",\n"s
+     << "  \"cplusplus\": "s << __cplusplus << ",\n"s
+     << "  \"elements\": "s << nof_elements << ",\n"s
+     << "  \"threads\": "s << cmappar::default_threads() << ",\n"s
+     << "  \"results\": ["s;
+  auto sep = "\n"s;
+  for (auto const & rec : records) {
+    os << sep << "    { \"group\": "s << quoted(rec.group)
+       << ", \"name\": "s << quoted(rec.what)
+       << ", \"ms\": "s << std::fixed << std::setprecision(3) << rec.ms
+       << ", \"result\": "s << rec.result << " }"s;
+    sep = ",\n"s;
+  }
+  os << "\n  ]\n}\n"s;
+}
+
+/*
+ *  MARK: counting_allocator
+ *  std::allocator that keeps a running total of the bytes and blocks it
+ *  has handed out and not yet taken back.  Counts are what containers
+ *  request; the heap's own per-block overhead comes on top.
+ */
+inline std::size_t live_bytes  = 0;
+inline std::size_t live_blocks = 0;
+
+template <class T>
+struct counting_allocator {
+  using value_type = T;
+
+  counting_allocator() = default;
+  template <class U>
+  counting_allocator(counting_allocator<U> const &) noexcept {}
+
+  auto allocate(std::size_t count) -> T * {
+    live_bytes += count * sizeof(T);
+    ++live_blocks;
+    return std::allocator<T> {}.allocate(count);
+  }
+  auto deallocate(T * ptr, std::size_t count) noexcept -> void {
+    live_bytes -= count * sizeof(T);
+    --live_blocks;
+    std::allocator<T> {}.deallocate(ptr, count);
+  }
+
+  friend bool operator==(counting_allocator const &, counting_allocator const &) { return true; }
+};
+
+} /* namespace bench */
+
+//  MARK: - Function Prototype.
+auto B_setops(std::size_t nof_elements) -> void;
+auto B_timeseries(std::size_t nof_elements) -> void;
+auto B_snapshots(std::size_t nof_elements) -> void;
+auto B_readers(std::size_t nof_elements) -> void;
+auto B_churn(std::size_t nof_elements) -> void;
+auto B_loader(std::size_t nof_elements) -> void;
+auto B_traverse(std::size_t nof_elements) -> void;
+auto B_views(std::size_t nof_elements) -> void;
+auto B_small(std::size_t nof_elements) -> void;
+auto B_multi(std::size_t nof_elements) -> void;
+auto B_instrument(std::size_t nof_elements) -> void;
+auto B_compare(std::size_t nof_elements) -> void;
+auto B_cache(std::size_t nof_elements) -> void;
+
+//  MARK: - Implementation.
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: main()
+ */
+int main(int argc, const char * argv[]) {
+  std::cout << "CF.STL_Containers_Map - benchmarks\n"s;
+  std::cout << "C++ Version: "s << __cplusplus << std::endl;
+
+  auto nof_elements = std::size_t { 200'000 };
+  auto json = std::optional<std::string> {};
+  for (int ix = 1; ix < argc; ++ix) {
+    auto const arg = std::string_view(argv[ix]);
+    if (arg == "--json" && ix + 1 < argc) { json = argv[++ix]; }
+    else                                  { nof_elements = static_cast<std::size_t>(std::stoull(argv[ix])); }
+  }
+  std::cout << "elements: "s << nof_elements
+            << ", threads: "s << cmappar::default_threads()
+            << ", build: "s << CMAP_BUILD_FLAVOR << '\n';
+
+  using bench_fn = auto (*)(std::size_t) -> void;
+  auto const benchmarks = std::initializer_list<std::pair<std::string_view, bench_fn>> {
+    { "setops",     &B_setops },
+    { "timeseries", &B_timeseries },
+    { "snapshots",  &B_snapshots },
+    { "readers",    &B_readers },
+    { "churn",      &B_churn },
+    { "loader",     &B_loader },
+    { "traverse",   &B_traverse },
+    { "views",      &B_views },
+    { "small",      &B_small },
+    { "multi",      &B_multi },
+    { "instrument", &B_instrument },
+    { "compare",    &B_compare },
+    { "cache",      &B_cache },
+  };
+
+  std::cout << '\n' << konst::dlm << std::endl;
+  for (auto const & [name, run] : benchmarks) {
+    bench::group = name;
+    run(nof_elements);
+  }
+
+  if (json) {
+    std::ofstream ofs(*json);
+    bench::write_json(ofs, nof_elements);
+    std::cout << "results written to "s << *json << '\n';
+  }
+
+  return 0;
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_setops()
+ *  Galloping set kernels against the hand-written for + find loop.
+ */
+auto B_setops(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "set algebra: intersection / difference / join"s << '\n';
+
+  auto const nel = static_cast<int>(nof_elements);
+  std::mt19937 rng(42);
+
+  std::map<int, int> base;
+  for (int i_ = 0; i_ < nel; ++i_) { base.emplace_hint(base.end(), i_, i_); }
+
+  std::map<int, char> dense;    // every other key of base
+  for (int i_ = 0; i_ < nel; i_ += 2) { dense.emplace_hint(dense.end(), i_, 'd'); }
+
+  std::map<int, char> sparse;   // ~0.1% of base
+  std::uniform_int_distribution<int> pick(0, nel * 2);
+  for (int i_ = 0; i_ < std::max(1, nel / 1000); ++i_) { sparse.emplace(pick(rng), 's'); }
+
+  auto run = [&base](std::string const & label, auto const & other) {
+    std::cout << label << '\n';
+
+    bench::timeit("naive for + find intersection"s, [&] {
+      std::map<int, int> out;
+      for (auto const & kv : base) {
+        if (other.find(kv.first) != other.end()) { out.insert(kv); }
+      }
+      return out.size();
+    });
+    bench::timeit("cmapset::intersection (lazy count)"s, [&] {
+      auto const view = cmapset::intersection(base, other);
+      return std::distance(view.begin(), view.end());
+    });
+    bench::timeit("cmapset::intersection -> to_map"s, [&] {
+      return cmapset::to_map(cmapset::intersection(base, other)).size();
+    });
+    bench::timeit("cmapset::intersection -> to_map (parallel)"s, [&] {
+      return cmapset::to_map(cmapset::intersection(base, other),
+                             cmappar::default_threads()).size();
+    });
+
+    bench::timeit("naive for + find difference"s, [&] {
+      std::map<int, int> out;
+      for (auto const & kv : base) {
+        if (other.find(kv.first) == other.end()) { out.insert(kv); }
+      }
+      return out.size();
+    });
+    bench::timeit("cmapset::difference -> to_map"s, [&] {
+      return cmapset::to_map(cmapset::difference(base, other)).size();
+    });
+
+    bench::timeit("naive for + find join"s, [&] {
+      std::map<int, std::pair<int, char>> out;
+      for (auto const & kv : base) {
+        if (auto it = other.find(kv.first); it != other.end()) {
+          out.emplace(kv.first, std::pair(kv.second, it->second));
+        }
+      }
+      return out.size();
+    });
+    bench::timeit("cmapset::join -> to_map"s, [&] {
+      return cmapset::to_map(cmapset::join(base, other)).size();
+    });
+
+    bench::timeit("naive for + find (small side drives)"s, [&] {
+      std::size_t hits = 0;
+      for (auto const & kv : other) { hits += base.count(kv.first); }
+      return hits;
+    });
+    bench::timeit("cmapset::intersection (small side drives)"s, [&] {
+      auto const view = cmapset::intersection(other, base);
+      return std::distance(view.begin(), view.end());
+    });
+  };
+
+  run("balanced: base x every other key"s, dense);
+  run("skewed:   base x 0.1% random keys"s, sparse);
+
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_timeseries()
+ *  In-order appends, time lookups and reverse scans: std::map against
+ *  the chunked, delta-encoded cmapts::timeseries_map.
+ */
+auto B_timeseries(std::size_t nof_elements) -> void {
+  using namespace std::chrono;
+  std::cout << konst::dot << '\n';
+  std::cout << "time series: append / lower_bound / reverse scan"s << '\n';
+
+  auto const t0 = sys_days(January / 1 / 2023);
+  std::mt19937 rng(42);
+  // irregular sampling: 1 to 4 seconds apart
+  std::uniform_int_distribution<int> jitter(1, 4);
+  std::vector<sys_seconds> stamps;
+  stamps.reserve(nof_elements);
+  auto at = sys_seconds(t0);
+  for (std::size_t ix = 0; ix < nof_elements; ++ix) {
+    at += seconds(jitter(rng));
+    stamps.push_back(at);
+  }
+  std::vector<sys_seconds> probes(stamps.size() / 4);
+  std::uniform_int_distribution<std::size_t> pick(0, stamps.size() - 1);
+  for (auto & probe : probes) { probe = stamps[pick(rng)] - seconds(1); }
+
+  std::map<sys_seconds, double> tree;
+  cmapts::timeseries_map<sys_seconds, double> series;
+
+  bench::timeit("std::map emplace_hint(end) append"s, [&] {
+    for (auto const & stamp : stamps) { tree.emplace_hint(tree.end(), stamp, 1.0); }
+    return tree.size();
+  });
+  bench::timeit("cmapts::timeseries_map append"s, [&] {
+    for (auto const & stamp : stamps) { series.try_emplace(stamp, 1.0); }
+    return series.size();
+  });
+
+  bench::timeit("std::map lower_bound"s, [&] {
+    std::size_t hits = 0;
+    for (auto const & probe : probes) { hits += tree.lower_bound(probe) != tree.end(); }
+    return hits;
+  });
+  bench::timeit("cmapts::timeseries_map lower_bound"s, [&] {
+    std::size_t hits = 0;
+    for (auto const & probe : probes) { hits += series.lower_bound(probe) != series.end(); }
+    return hits;
+  });
+
+  bench::timeit("std::map reverse scan"s, [&] {
+    std::size_t seen = 0;
+    for (auto it = tree.crbegin(); it != tree.crend(); ++it) { seen += it->second > 0.0; }
+    return seen;
+  });
+  bench::timeit("cmapts::timeseries_map reverse scan"s, [&] {
+    std::size_t seen = 0;
+    for (auto it = series.crbegin(); it != series.crend(); ++it) { seen += it->second > 0.0; }
+    return seen;
+  });
+
+  // a libstdc++ / libc++ map node: 4 links/colour words plus the pair
+  auto const node_bytes = 4 * sizeof(void *) + sizeof(std::pair<sys_seconds const, double>);
+  std::cout << "key + link bytes per element: std::map ~"s << node_bytes - sizeof(double)
+            << ", timeseries_map "s << std::fixed << std::setprecision(2)
+            << static_cast<double>(series.key_bytes()) / static_cast<double>(series.size())
+            << '\n';
+
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_snapshots()
+ *  A reader takes a consistent copy before every writer update:
+ *  std::map deep copies, cmappm::persistent_map shares all but the path.
+ */
+auto B_snapshots(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "snapshots: copy + update"s << '\n';
+
+  auto const nel = static_cast<int>(nof_elements);
+  auto const rounds = 100;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> pick(0, nel - 1);
+
+  std::map<int, int> tree;
+  cmappm::persistent_map<int, int> shared;
+  bench::timeit("std::map build"s, [&] {
+    for (int i_ = 0; i_ < nel; ++i_) { tree.emplace_hint(tree.end(), i_, i_); }
+    return tree.size();
+  });
+  bench::timeit("cmappm::persistent_map build"s, [&] {
+    for (int i_ = 0; i_ < nel; ++i_) { shared.try_emplace(i_, i_); }
+    return shared.size();
+  });
+
+  bench::timeit("std::map copy + update (x100)"s, [&] {
+    std::size_t seen = 0;
+    for (int r_ = 0; r_ < rounds; ++r_) {
+      auto const snapshot = tree;
+      tree[pick(rng)] += 1;
+      seen += snapshot.size();
+    }
+    return seen;
+  });
+  bench::timeit("cmappm::persistent_map copy + update (x100)"s, [&] {
+    std::size_t seen = 0;
+    for (int r_ = 0; r_ < rounds; ++r_) {
+      auto const snapshot = shared;
+      shared.update(pick(rng), [](int & value) { value += 1; });
+      seen += snapshot.size();
+    }
+    return seen;
+  });
+
+  bench::timeit("std::map find"s, [&] {
+    std::size_t hits = 0;
+    for (int i_ = 0; i_ < nel; i_ += 4) { hits += tree.find(pick(rng)) != tree.end(); }
+    return hits;
+  });
+  bench::timeit("cmappm::persistent_map contains"s, [&] {
+    std::size_t hits = 0;
+    for (int i_ = 0; i_ < nel; i_ += 4) { hits += shared.contains(pick(rng)); }
+    return hits;
+  });
+
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_readers()
+ *  Reader scaling, 1 thread up to every core, each thread doing the same
+ *  number of lookups while a writer republishes every millisecond:
+ *  std::map behind a std::shared_mutex against cmaprcu::rcu_map.
+ */
+auto B_readers(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "read-mostly: shared_mutex vs rcu_map, lookups per reader: "s
+            << nof_elements << '\n';
+
+  auto const nkeys = 1'000;
+  std::map<int, int> seed;
+  for (int i_ = 0; i_ < nkeys; ++i_) { seed.emplace_hint(seed.end(), i_, i_); }
+
+  std::map<int, int> locked(seed);
+  std::shared_mutex locked_mx;
+  cmaprcu::rcu_map<int, int> rcu(seed);
+
+  auto lookups = [nof_elements](auto && probe) {
+    std::mt19937 rng(std::random_device {}());
+    std::uniform_int_distribution<int> pick(0, nkeys - 1);
+    std::size_t hits = 0;
+    for (std::size_t ix = 0; ix < nof_elements; ++ix) { hits += probe(pick(rng)); }
+    return hits;
+  };
+
+  auto const max_threads = cmappar::default_threads();
+  for (unsigned nthreads = 1; ; nthreads = std::min(nthreads * 2, max_threads)) {
+    auto const label = std::to_string(nthreads) + " reader(s)"s;
+    std::vector<std::size_t> hits(nthreads);
+
+    {
+      std::jthread writer([&](std::stop_token stop) {
+        for (int bump = 0; !stop.stop_requested(); ++bump) {
+          { auto lock = std::unique_lock(locked_mx); locked[bump % nkeys] = bump; }
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      });
+      bench::timeit("std::shared_mutex + std::map, "s + label, [&] {
+        cmappar::for_chunks(nthreads, nthreads, [&](std::size_t part, std::size_t, std::size_t) {
+          hits[part] = lookups([&](int key) {
+            auto lock = std::shared_lock(locked_mx);
+            return locked.find(key) != locked.end();
+          });
+        });
+        return std::accumulate(hits.begin(), hits.end(), std::size_t { 0 });
+      });
+    }
+
+    {
+      std::jthread writer([&](std::stop_token stop) {
+        for (int bump = 0; !stop.stop_requested(); ++bump) {
+          rcu.insert_or_assign(bump % nkeys, bump);
+          rcu.publish();
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+      });
+      bench::timeit("cmaprcu::rcu_map, "s + label, [&] {
+        cmappar::for_chunks(nthreads, nthreads, [&](std::size_t part, std::size_t, std::size_t) {
+          hits[part] = lookups([&](int key) {
+            auto const snap = rcu.pin();
+            return snap->find(key) != snap->end();
+          });
+        });
+        return std::accumulate(hits.begin(), hits.end(), std::size_t { 0 });
+      });
+    }
+
+    if (nthreads == max_threads) { break; }
+  }
+
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_churn()
+ *  Sliding key window: erase the oldest key, insert a new one.  std::map
+ *  frees and allocates a node per step; recycling_map reuses the node.
+ */
+auto B_churn(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "churn: erase oldest + insert newest"s << '\n';
+
+  auto const window = 10'000;
+  auto const steps = static_cast<int>(nof_elements) * 5;
+
+  bench::timeit("std::map<int, int> erase + emplace"s, [&] {
+    std::map<int, int> map;
+    for (int i_ = 0; i_ < window; ++i_) { map.emplace_hint(map.end(), i_, i_); }
+    for (int i_ = window; i_ < window + steps; ++i_) {
+      map.erase(i_ - window);
+      map.emplace_hint(map.end(), i_, i_);
+    }
+    return map.size();
+  });
+  auto reuse_rate = 0.0;
+  bench::timeit("cmaprec::recycling_map<int, int>"s, [&] {
+    cmaprec::recycling_map<int, int> map;
+    for (int i_ = 0; i_ < window; ++i_) { map.try_emplace(i_, i_); }
+    for (int i_ = window; i_ < window + steps; ++i_) {
+      map.erase(i_ - window);
+      map.try_emplace(i_, i_);
+    }
+    reuse_rate = map.stats().reuse_rate();
+    return map.size();
+  });
+  std::cout << std::setw(20) << ' ' << "node reuse rate: "s << std::fixed << std::setprecision(3)
+            << reuse_rate << '\n';
+
+  // values with their own heap buffer: assignment keeps the capacity
+  auto const payload = std::string(64, '*');
+  bench::timeit("std::map<int, std::string> erase + emplace"s, [&] {
+    std::map<int, std::string> map;
+    for (int i_ = 0; i_ < window; ++i_) { map.emplace_hint(map.end(), i_, payload); }
+    for (int i_ = window; i_ < window + steps; ++i_) {
+      map.erase(i_ - window);
+      map.emplace_hint(map.end(), i_, payload);
+    }
+    return map.size();
+  });
+  bench::timeit("cmaprec::recycling_map<int, std::string>"s, [&] {
+    cmaprec::recycling_map<int, std::string> map;
+    for (int i_ = 0; i_ < window; ++i_) { map.insert_or_assign(i_, payload); }
+    for (int i_ = window; i_ < window + steps; ++i_) {
+      map.erase(i_ - window);
+      map.insert_or_assign(i_, payload);
+    }
+    return map.size();
+  });
+
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_loader()
+ *  Loading a "key,value" file: getline + parse + emplace one line at a
+ *  time against the overlapped cmapio::load_map pipeline.
+ */
+auto B_loader(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "file load: synchronous vs pipelined"s << '\n';
+
+  auto const path = std::filesystem::temp_directory_path() / "cf_stl_maps_bench.csv"s;
+  {
+    std::ofstream out(path);
+    std::mt19937 rng(42);
+    for (std::size_t ix = 0; ix < nof_elements * 5; ++ix) {
+      out << "sensor-"s << rng() % (nof_elements * 2) << ',' << rng() % 1'000 << '\n';
+    }
+  }
+  std::cout << "file bytes: "s << std::filesystem::file_size(path) << '\n';
+
+  auto parse = [](std::string_view line) -> std::optional<std::pair<std::string, int>> {
+    auto const comma = line.find(',');
+    if (comma == std::string_view::npos) { return std::nullopt; }
+    auto value = 0;
+    std::from_chars(line.data() + comma + 1, line.data() + line.size(), value);
+    return std::pair(std::string(line.substr(0, comma)), value);
+  };
+  using map_type = std::map<std::string, int>;
+
+  bench::timeit("cmapio::read_map (getline, parse, emplace)"s, [&] {
+    return cmapio::read_map<map_type>(path, parse).size();
+  });
+
+  cmapio::thread_pool pool;
+  for (auto chunk_bytes : { std::size_t { 256 * 1'024 }, std::size_t { 4 * 1'024 * 1'024 } }) {
+    cmapio::load_options opts;
+    opts.chunk_bytes = chunk_bytes;
+    bench::timeit("cmapio::load_map, "s + std::to_string(chunk_bytes / 1'024) + " KiB chunks"s, [&] {
+      return cmapio::load_map<map_type>(pool, path, parse, opts).get().size();
+    });
+  }
+
+  std::filesystem::remove(path);
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_traverse()
+ *  The mag[cur] = std::hypot(...) update over 50 x nof_elements nodes
+ *  (10^7 at the default size): one thread walking the tree against the
+ *  work-stealing traversal, for std::map and for the order-statistic
+ *  tree, whose leaves are found with nth() rather than a walk.
+ */
+auto B_traverse(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "traversal: in-place hypot update and ordered reduction"s << '\n';
+
+  auto const nel = nof_elements * 50;
+  // a few hypot calls per node so the work, not the walk, dominates
+  auto heavy = [](double x_val) {
+    auto mag = 0.0;
+    for (int r_ = 1; r_ <= 8; ++r_) { mag += std::hypot(x_val, static_cast<double>(r_)); }
+    return mag;
+  };
+
+  std::map<double, double> mag;
+  for (std::size_t ix = 0; ix < nel; ++ix) {
+    mag.emplace_hint(mag.end(), static_cast<double>(ix), 0.0);
+  }
+  cmapws::traverse_options const opts { .grain = 4'096 };
+
+  bench::timeit("serial for: mag[cur] = hypot(...)"s, [&] {
+    for (auto & kvpair : mag) { kvpair.second = heavy(kvpair.first); }
+    return mag.size();
+  });
+  bench::timeit("cmapws::parallel_for_each"s, [&] {
+    cmapws::parallel_for_each(mag, [&](auto & kvpair) { kvpair.second = heavy(kvpair.first); }, opts);
+    return mag.size();
+  });
+  bench::timeit("std::accumulate of magnitudes"s, [&] {
+    return std::accumulate(mag.begin(), mag.end(), 0.0,
+                           [](double acc, auto const & kvpair) { return acc + kvpair.second; }) > 0.0
+         ? mag.size() : 0;
+  });
+  bench::timeit("cmapws::parallel_reduce of magnitudes"s, [&] {
+    return cmapws::parallel_reduce(mag, 0.0, [](auto const & kvpair) { return kvpair.second; },
+                                   std::plus<> {}, opts) > 0.0
+         ? mag.size() : 0;
+  });
+  mag.clear();
+
+  cmapos::order_statistic_map<double, double> ranked;
+  for (std::size_t ix = 0; ix < nof_elements * 5; ++ix) {
+    ranked.emplace_hint(ranked.end(), static_cast<double>(ix), 0.0);
+  }
+  bench::timeit("order_statistic_map serial (5 x n)"s, [&] {
+    for (auto & kvpair : ranked) { kvpair.second = heavy(kvpair.first); }
+    return ranked.size();
+  });
+  bench::timeit("order_statistic_map parallel, nth() splits"s, [&] {
+    cmapws::parallel_for_each(ranked, [&](auto & kvpair) { kvpair.second = heavy(kvpair.first); }, opts);
+    return ranked.size();
+  });
+
+  std::cout << "pool threads: "s << cmapws::work_stealing_pool::shared().size() << "\n\n"s;
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_views()
+ *  for (auto kvpair : map) copies every pair, string payload included;
+ *  the views hand out references.  A filtered subset built by inserting
+ *  without a hint against to_map()'s end()-hinted bulk build.
+ */
+auto B_views(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "views: copying loops vs references, filtered subsets"s << '\n';
+
+  std::map<int, std::string> map;
+  for (std::size_t ix = 0; ix < nof_elements; ++ix) {
+    map.emplace_hint(map.end(), static_cast<int>(ix), "value-"s + std::to_string(ix) + std::string(24, '.'));
+  }
+  auto const rounds = 20;
+
+  bench::timeit("for (auto kvpair : map), 20 rounds"s, [&] {
+    std::size_t bytes = 0;
+    for (int r_ = 0; r_ < rounds; ++r_) {
+      for (auto kvpair : map) { bytes += kvpair.second.size(); }
+    }
+    return bytes;
+  });
+  bench::timeit("for (auto & name : values(map)), 20 rounds"s, [&] {
+    std::size_t bytes = 0;
+    for (int r_ = 0; r_ < rounds; ++r_) {
+      for (auto const & name : cmapview::values(map)) { bytes += name.size(); }
+    }
+    return bytes;
+  });
+
+  auto const lo = static_cast<int>(nof_elements / 4);
+  auto const hi = static_cast<int>(nof_elements / 4 * 3);
+  auto even = [](auto const & kvpair) { return kvpair.first % 2 == 0; };
+
+  bench::timeit("subset: scan all + insert"s, [&] {
+    std::map<int, std::string> out;
+    for (auto const & kvpair : map) {
+      if (kvpair.first >= lo && kvpair.first < hi && even(kvpair)) { out.insert(kvpair); }
+    }
+    return out.size();
+  });
+  bench::timeit("subset: to_map(filter(range(lo, hi)))"s, [&] {
+    return cmapview::to_map(cmapview::filter(cmapview::range(map, lo, hi), even)).size();
+  });
+
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_small()
+ *  Short-lived per-request maps: 5 x nof_elements maps, each built,
+ *  probed a few times and destroyed.  Sizes follow maps.cpp: mostly 2
+ *  to 6 elements, one in sixteen with 7 to 12 so the spill path is
+ *  timed as well.
+ */
+auto B_small(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "small maps: build, probe, destroy per request"s << '\n';
+
+  auto const requests = nof_elements * 5;
+  std::vector<std::uint8_t> sizes(requests);
+  std::mt19937 rng(42);
+  for (auto & size : sizes) {
+    size = static_cast<std::uint8_t>(rng() % 16 == 0 ? 7 + rng() % 6 : 2 + rng() % 5);
+  }
+
+  auto run = [&]<class Map>(std::string_view what, std::type_identity<Map>) {
+    bench::timeit(what, [&] {
+      std::size_t hits = 0;
+      for (auto size : sizes) {
+        Map map;
+        for (int k_ = size; k_ > 0; --k_) { map.try_emplace(k_ * 3, k_); }
+        for (int k_ = 0; k_ < 8; ++k_) { hits += map.count(k_ * 3); }
+      }
+      return hits;
+    });
+  };
+  run("std::map<int, int>"s, std::type_identity<std::map<int, int>> {});
+  run("cmapsm::small_map<int, int, 4>"s, std::type_identity<cmapsm::small_map<int, int, 4>> {});
+  run("cmapsm::small_map<int, int, 8>"s, std::type_identity<cmapsm::small_map<int, int, 8>> {});
+  run("cmapsm::small_map<int, int, 16>"s, std::type_identity<cmapsm::small_map<int, int, 16>> {});
+
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_multi()
+ *  5 x nof_elements (key, value) pairs with 1, 4 and 32 values per key,
+ *  inserted in random order: std::multimap (one node per value) against
+ *  cmapmv::bucket_multimap (one node and one bucket per key).  Memory is
+ *  measured with bench::counting_allocator.
+ */
+auto B_multi(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "multi-value maps: memory and equal_range"s << '\n';
+
+  using alloc = bench::counting_allocator<std::pair<int const, int>>;
+  using multimap_type = std::multimap<int, int, std::less<int>, alloc>;
+  using bucket_type   = cmapmv::bucket_multimap<int, int, std::less<int>, alloc>;
+
+  auto const total = nof_elements * 5;
+  auto memory = [](std::string_view what) {
+    std::cout << std::setw(20) << ' ' << std::left << std::setw(28) << what << std::right
+              << std::setw(12) << bench::live_bytes << " bytes in "s
+              << std::setw(9) << bench::live_blocks << " blocks\n"s;
+  };
+
+  for (std::size_t per_key : { 1, 4, 32 }) {
+    auto const nkeys = static_cast<int>(total / per_key);
+    std::vector<std::pair<int, int>> input;
+    input.reserve(total);
+    for (std::size_t ix = 0; ix < total; ++ix) {
+      input.emplace_back(static_cast<int>(ix % static_cast<std::size_t>(nkeys)), static_cast<int>(ix));
+    }
+    std::shuffle(input.begin(), input.end(), std::mt19937(42));
+    std::cout << per_key << " value(s) per key, "s << nkeys << " keys\n"s;
+
+    {
+      multimap_type mmap;
+      bench::timeit("std::multimap insert"s, [&] {
+        for (auto const & [key, value] : input) { mmap.emplace(key, value); }
+        return mmap.size();
+      });
+      memory("std::multimap"s);
+      bench::timeit("std::multimap equal_range sweep"s, [&] {
+        std::size_t sum = 0;
+        for (int key = 0; key < nkeys; ++key) {
+          auto [first, last] = mmap.equal_range(key);
+          for (; first != last; ++first) { sum += static_cast<std::size_t>(first->second); }
+        }
+        return sum;
+      });
+    }
+    {
+      bucket_type bmap;
+      bench::timeit("cmapmv::bucket_multimap insert"s, [&] {
+        for (auto const & [key, value] : input) { bmap.insert(key, value); }
+        return bmap.size();
+      });
+      memory("cmapmv::bucket_multimap"s);
+      bmap.shrink_to_fit();
+      memory("  after shrink_to_fit()"s);
+      bench::timeit("cmapmv::bucket_multimap equal_range sweep"s, [&] {
+        std::size_t sum = 0;
+        for (int key = 0; key < nkeys; ++key) {
+          for (auto value : bmap.equal_range(key)) { sum += static_cast<std::size_t>(value); }
+        }
+        return sum;
+      });
+    }
+  }
+
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_instrument()
+ *  What tracing costs: the same find / operator[] mix on std::map, on
+ *  cmapinst::traced_map (std::map itself unless built with
+ *  CMAP_INSTRUMENT=1) and on cmapinst::instrumented_map.
+ */
+auto B_instrument(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "instrumentation: overhead per operation"s << '\n';
+
+  std::vector<int> keys(nof_elements * 5);
+  std::mt19937 rng(42);
+  for (auto & key : keys) { key = static_cast<int>(rng() % nof_elements); }
+
+  auto run = [&]<class Map>(std::string_view what, Map & map) {
+    bench::timeit(what, [&] {
+      std::size_t hits = 0;
+      for (auto key : keys) {
+        if (map.find(key) != map.end()) { ++hits; }
+        else                            { map[key] = key; }
+      }
+      return hits;
+    });
+  };
+  std::map<int, int> plain;
+  cmapinst::traced_map<int, int> traced;
+  cmapinst::instrumented_map<int, int> instrumented;
+  run("std::map find / operator[]"s, plain);
+  run(cmapinst::enabled ? "cmapinst::traced_map (CMAP_INSTRUMENT=1)"s
+                        : "cmapinst::traced_map (CMAP_INSTRUMENT=0)"s, traced);
+  run("cmapinst::instrumented_map"s, instrumented);
+
+  auto const snap = instrumented.stats().take_snapshot();
+  std::cout << std::setw(20) << ' ' << "find p50 < "s << snap[cmapinst::op::find].quantile_nanos(0.5)
+            << " ns, p99 < "s << snap[cmapinst::op::find].quantile_nanos(0.99) << " ns\n\n"s;
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_compare()
+ *  Comparison-bound lookups: the same keys and probes through std::less
+ *  and cmapcmp::fast_less.  The maps are kept small enough to stay in
+ *  cache, so the compares rather than the misses set the time.
+ *  "customer:" keys share their first 8 bytes, the worst case for the
+ *  prefix word, which then only adds work.
+ */
+auto B_compare(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "comparators: std::less against cmapcmp::fast_less"s << '\n';
+
+  auto const nof_keys = std::min(nof_elements, std::size_t { 4'096 });
+
+  // one probe list per key set; the maps are filled in lockstep, so their
+  //  nodes interleave and none gets a better heap layout than the others
+  std::mt19937 rng(42);
+  auto compete = [&]<class Key, class ... Compare>(std::string_view what, std::vector<Key> const & keys,
+                                                   std::pair<std::string_view, Compare> ... comps) {
+    std::vector<Key> probes(nof_elements * 5);
+    for (auto & probe : probes) { probe = keys[rng() % keys.size()]; }
+    auto maps = std::tuple<std::map<Key, int, Compare> ...> {};
+    for (auto const & key : keys) {
+      std::apply([&](auto & ... map) { (map.try_emplace(key, 0), ...); }, maps);
+    }
+    auto time = [&](std::string_view label, auto const & map) {
+      bench::timeit(std::string(what) + ' ' + std::string(label), [&] {
+        std::size_t hits = 0;
+        for (auto const & probe : probes) { hits += map.count(probe); }
+        return hits;
+      });
+    };
+    std::apply([&](auto const & ... map) { (time(comps.first, map), ...); }, maps);
+  };
+  auto both = [&]<class Key>(std::string_view what, std::vector<Key> const & keys) {
+    compete(what, keys, std::pair("std::less"sv, std::less<Key> {}),
+                        std::pair("fast_less"sv, cmapcmp::fast_less<Key> {}));
+  };
+
+  std::vector<std::string> words(nof_keys);
+  for (auto & word : words) {
+    word.resize(4 + rng() % 13);
+    for (auto & ch : word) { ch = static_cast<char>('a' + rng() % 26); }
+  }
+  compete("string words"sv, words, std::pair("std::less"sv, std::less<std::string> {}),
+                                   std::pair("fast_less"sv, cmapcmp::fast_less<std::string> {}),
+                                   std::pair("length_first_less"sv, cmapcmp::length_first_less {}));
+
+  std::vector<std::string> customers(nof_keys);
+  for (auto & customer : customers) {
+    auto digits = std::to_string(rng() % 100'000'000);
+    customer = "customer:"s + std::string(8 - digits.size(), '0') + digits;
+  }
+  both("string customer:NNNNNNNN"sv, customers);
+
+  std::vector<std::chrono::year_month_day> dates(nof_keys);
+  for (auto & date : dates) {
+    date = std::chrono::year_month_day(std::chrono::sys_days(std::chrono::days(rng() % 40'000)));
+  }
+  both("year_month_day"sv, dates);
+
+  std::vector<std::pair<int, int>> pairs(nof_keys);
+  for (auto & pair : pairs) {
+    pair = { static_cast<int>(rng() % 1'000), static_cast<int>(rng()) };
+  }
+  both("pair<int, int>"sv, pairs);
+
+  std::vector<std::pair<std::string, int>> tagged(nof_keys);
+  for (std::size_t ix = 0; ix < tagged.size(); ++ix) {
+    tagged[ix] = { words[ix], static_cast<int>(rng() % 4) };
+  }
+  both("pair<string, int>"sv, tagged);
+  std::cout << '\n';
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: B_cache()
+ *  A lookup cache under a skewed trace with periodic one-off scans: the
+ *  hand-written std::map + std::list LRU, then cmapcache::cache_map with
+ *  lru and with w_tinylfu.  The result is the number of hits.
+ */
+auto B_cache(std::size_t nof_elements) -> void {
+  std::cout << konst::dot << '\n';
+  std::cout << "bounded cache: std::map + std::list LRU against cmapcache::cache_map"s << '\n';
+
+  auto const universe = std::max(nof_elements * 2, std::size_t { 100 });
+  auto const capacity = std::max(nof_elements / 20, std::size_t { 10 });
+
+  // zipf(0.9) over universe; the last 100 of every 1000 requests scan fresh keys
+  std::mt19937 rng(42);
+  std::vector<double> cdf(universe);
+  auto total = 0.0;
+  for (std::size_t ix = 0; ix < universe; ++ix) { cdf[ix] = total += 1.0 / std::pow(static_cast<double>(ix + 1), 0.9); }
+  std::uniform_real_distribution<double> pick(0.0, total);
+  std::vector<int> trace(nof_elements * 5);
+  auto scan = static_cast<int>(universe);
+  for (std::size_t ix = 0; ix < trace.size(); ++ix) {
+    trace[ix] = ix % 1'000 < 900
+              ? static_cast<int>(std::lower_bound(cdf.begin(), cdf.end(), pick(rng)) - cdf.begin())
+              : scan++;
+  }
+
+  bench::timeit("std::map + std::list LRU, by hand"s, [&] {
+    std::list<int> recency;
+    std::map<int, std::pair<int, std::list<int>::iterator>> cache;
+    std::size_t hits = 0;
+    for (auto key : trace) {
+      if (auto it = cache.find(key); it != cache.end()) {
+        recency.splice(recency.begin(), recency, it->second.second);
+        ++hits;
+        continue;
+      }
+      recency.push_front(key);
+      cache.try_emplace(key, key, recency.begin());
+      if (cache.size() > capacity) {
+        cache.erase(recency.back());
+        recency.pop_back();
+      }
+    }
+    return hits;
+  });
+
+  auto run = [&](std::string_view label, auto & cache) {
+    bench::timeit(label, [&] {
+      for (auto key : trace) {
+        if (!cache.find(key)) { cache.insert_or_assign(key, key); }
+      }
+      return cache.stats().hits;
+    });
+  };
+  cmapcache::cache_map<int, int, std::less<>, cmapcache::lru> lru({ .max_entries = capacity });
+  run("cmapcache::cache_map lru"sv, lru);
+  cmapcache::cache_map<int, int> tinylfu({ .max_entries = capacity });
+  run("cmapcache::cache_map w_tinylfu"sv, tinylfu);
+  std::cout << '\n';
+}
@@ -0,0 +1,944 @@
+//
+//  map_fuzz.cpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  Differential tester: one operation stream, decoded from bytes, is
+//  replayed against std::map and each alternative engine side by side,
+//  and every result and the full contents are compared after each step.
+//  usage: map_fuzz [runs [length]]         random streams, checked after every step
+//         map_fuzz --seed N [length]       one stream again, e.g. a failing seed
+//         map_fuzz --throughput [seconds]  as many streams as fit, checked per stream
+//         map_fuzz --replay file ...       replay saved inputs (libFuzzer crash files)
+//  Built with -DCMAP_LIBFUZZER=1 -fsanitize=fuzzer the file is a libFuzzer
+//  target instead and has no main().
+//
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <algorithm>
+#include <ranges>
+#include <utility>
+#include <random>
+#include <chrono>
+#include <map>
+#include <vector>
+#include <array>
+#include <span>
+#include <optional>
+#include <charconv>
+#include <system_error>
+#include <stdexcept>
+#include <concepts>
+#include <type_traits>
+#include <cstdlib>
+#include <cstddef>
+#include <limits>
+#include <cstdint>
+
+#include "art_map.hpp"
+#include "fingerprint_map.hpp"
+#include "order_statistic_map.hpp"
+#include "persistent_map.hpp"
+#include "recycling_map.hpp"
+#include "small_map.hpp"
+#include "bucket_multimap.hpp"
+#include "timeseries_map.hpp"
+
+//  CMAP_LIBFUZZER=1 replaces main() with LLVMFuzzerTestOneInput().
+#ifndef CMAP_LIBFUZZER
+#define CMAP_LIBFUZZER 0
+#endif
+
+using namespace std::literals::string_literals;
+
+//  MARK: - Definitions
+
+//  MARK: - Local Constants.
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace konst
+namespace konst {
+
+auto delimiter(char const dc = '-', size_t sl = 80) -> std::string const {
+  auto const dlm = std::string(sl, dc);
+  return dlm;
+}
+
+static
+auto const dlm = delimiter();
+
+static
+auto const dot = delimiter('.');
+
+} /* namespace konst */
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace fuzz
+namespace fuzz {
+
+/*
+ *  MARK: input
+ *  The operation stream.  Every byte sequence is a valid program: once
+ *  the bytes run out, reads return 0 and the replay stops.
+ */
+class input {
+public:
+  explicit input(std::span<std::uint8_t const> data) noexcept : data_(data) {}
+
+  auto empty() const noexcept -> bool { return pos_ >= data_.size(); }
+  auto byte() noexcept -> std::uint8_t { return empty() ? 0 : data_[pos_++]; }
+
+  // 8-bit keys collide often; bit 7 of the op code asks for 16-bit ones
+  auto key(std::uint8_t code) noexcept -> int {
+    auto const lo = byte();
+    if ((code & 0x80) == 0) { return static_cast<std::int8_t>(lo); }
+    return static_cast<std::int16_t>(byte() << 8 | lo);
+  }
+
+private:
+  std::span<std::uint8_t const> data_;
+  std::size_t pos_ = 0;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: fail()
+ *  A mismatch prints what differed, for which engine and at which step,
+ *  then aborts, which is what libFuzzer (and a sanitizer run) expects.
+ */
+inline std::string_view engine_name;
+inline std::size_t      step_count = 0;
+inline std::string      context;      // seed or file being replayed
+
+[[noreturn]] inline auto fail(char const * where, char const * what) -> void {
+  std::cerr << "map_fuzz: "s << engine_name << ": step "s << step_count
+            << ": "s << where << ": "s << what;
+  if (!context.empty()) { std::cerr << " ("s << context << ')'; }
+  std::cerr << std::endl;
+  std::abort();
+}
+
+inline auto expect(bool ok, char const * where, char const * what) -> void {
+  if (!ok) { fail(where, what); }
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: engine traits
+ *  stable_nodes: iterators and references stay valid across inserts,
+ *  other erases, swap, extract/insert and merge, as std::map promises.
+ *  small_map keeps inline elements in the object and moves them when it
+ *  spills; persistent_map copies paths on update.  Neither is checked.
+ */
+template <class Map>
+inline constexpr bool stable_nodes = true;
+
+template <class Key, class T, std::size_t N, class Compare>
+inline constexpr bool stable_nodes<cmapsm::small_map<Key, T, N, Compare>> = false;
+
+template <class Key, class T, class Compare>
+inline constexpr bool stable_nodes<cmappm::persistent_map<Key, T, Compare>> = false;
+
+/*
+ *  MARK: invariants()
+ *  Engine-specific checks run with every comparison.
+ */
+template <class Map>
+auto invariants(Map const &) -> void {}
+
+template <class Key, class T, std::size_t N, class Compare>
+auto invariants(cmapsm::small_map<Key, T, N, Compare> const & map) -> void {
+  expect(map.size() <= N || !map.is_inline(), "small_map", "more than N elements inline");
+}
+
+template <class Key, class T, class Compare, class Monoid>
+auto invariants(cmapos::order_statistic_map<Key, T, Compare, Monoid> const & map) -> void {
+  std::size_t index = 0;
+  for (auto it = map.begin(); it != map.end(); ++it, ++index) {
+    expect(map.nth(index) == it, "order_statistic_map", "nth() disagrees with iteration");
+    expect(map.index_of(it) == index, "order_statistic_map", "index_of() disagrees with iteration");
+    expect(map.rank(it->first) == index, "order_statistic_map", "rank() disagrees with iteration");
+  }
+  expect(map.index_of(map.end()) == map.size(), "order_statistic_map", "index_of(end()) != size()");
+}
+
+template <class Key, class T, class Compare, class Hash>
+auto invariants(cmapfp::fingerprinted_map<Key, T, Compare, Hash> const & map) -> void {
+  auto const fresh = cmapfp::fingerprinted_map<Key, T, Compare, Hash>(map.begin(), map.end());
+  expect(map.fingerprint() == fresh.fingerprint(), "fingerprinted_map", "fingerprint drifted");
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: comparisons
+ *  same(): two positions agree - both end(), or the same key and value.
+ *  compare(): same size and the same elements in the same order, walked
+ *  forwards and backwards.
+ */
+template <class Ref, class RefIt, class Map, class MapIt>
+auto same(Ref & ref, RefIt rit, Map & map, MapIt mit) -> bool {
+  if (rit == ref.end()) { return mit == map.end(); }
+  return mit != map.end() && mit->first == rit->first && mit->second == rit->second;
+}
+
+template <class Ref, class Map>
+auto compare(Ref const & ref, Map const & map, char const * where) -> void {
+  expect(map.size() == ref.size(), where, "size()");
+  expect(map.empty() == ref.empty(), where, "empty()");
+  auto mit = map.begin();
+  for (auto const & [key, value] : ref) {
+    expect(mit != map.end(), where, "iteration ended early");
+    expect(mit->first == key && mit->second == value, where, "element differs (forward)");
+    ++mit;
+  }
+  expect(mit == map.end(), where, "iteration ran past the end");
+  for (auto rit = ref.end(); rit != ref.begin(); ) {
+    --rit;
+    --mit;
+    expect(mit->first == rit->first && mit->second == rit->second, where, "element differs (backward)");
+  }
+  expect(mit == map.begin(), where, "backward walk did not reach begin()");
+}
+
+// optional(value) or nullopt when fn throws std::out_of_range
+template <class Fn>
+auto probe(Fn && fn) -> std::optional<int> {
+  try {
+    return fn();
+  }
+  catch (std::out_of_range const &) {
+    return std::nullopt;
+  }
+}
+
+// erase_if by whatever means the engine offers; returns the count
+template <class Map, class Pred>
+auto erase_matching(Map & map, Pred pred) -> std::size_t {
+  if constexpr (requires { erase_if(map, pred); }) {
+    return erase_if(map, pred);
+  }
+  else if constexpr (requires { map.erase(map.cbegin()); }) {
+    std::size_t erased = 0;
+    for (auto it = map.cbegin(); it != map.cend(); ) {
+      if (pred(*it)) { it = map.erase(it); ++erased; }
+      else           { ++it; }
+    }
+    return erased;
+  }
+  else {
+    std::vector<typename Map::key_type> keys;
+    for (auto const & item : map) {
+      if (pred(item)) { keys.push_back(item.first); }
+    }
+    for (auto const & key : keys) { map.erase(key); }
+    return keys.size();
+  }
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: differ
+ *  Two slots, each a std::map<int, int> and the engine under test, so
+ *  swap and merge have a partner.  Every op reads its code byte (bit 0
+ *  picks the slot, bits 1-6 the op, bit 7 the key width) and whatever
+ *  operands it needs.  Ops an engine lacks are no-ops for it.  Values
+ *  are the step number, so stale values show up.
+ *
+ *  A find() pins the element found (on engines with stable_nodes): from
+ *  then on its key must be found at the same address until it is erased,
+ *  following it through swap, extract/insert and merge.
+ */
+template <class Map>
+class differ {
+public:
+  using reference_map = std::map<int, int>;
+
+  enum class op : unsigned {
+    try_emplace, insert_or_assign, subscript, erase_key, erase_iterator,
+    find, at, bounds, swap, extract, merge, erase_if, clear, copy, restore,
+    update, move, emplace_hint,
+    nof_ops,
+  };
+
+  explicit differ(bool check_each) : check_each_(check_each) {}
+
+  auto run(input & in) -> std::size_t {
+    std::size_t steps = 0;
+    for (; !in.empty(); ++steps) {
+      step_count = steps;
+      apply(in);
+      if (check_each_) { check(); }
+    }
+    check();
+    return steps;
+  }
+
+private:
+  struct pin {
+    int          key;
+    void const * where;
+  };
+
+  struct slot {
+    reference_map      ref;
+    Map                map;
+    std::optional<pin> pinned;
+  };
+
+  auto apply(input & in) -> void {
+    auto const code  = in.byte();
+    auto &     self  = slots_[code & 1];
+    auto &     other = slots_[~code & 1];
+    auto const value = static_cast<int>(step_count);
+
+    switch (static_cast<op>((code >> 1 & 0x3f) % static_cast<unsigned>(op::nof_ops))) {
+    case op::try_emplace: {
+      auto const key = in.key(code);
+      auto const [rit, rin] = self.ref.try_emplace(key, value);
+      auto const [mit, min] = self.map.try_emplace(key, value);
+      expect(rin == min, "try_emplace", "inserted flag");
+      expect(same(self.ref, rit, self.map, mit), "try_emplace", "returned position");
+      break;
+    }
+
+    case op::insert_or_assign: {
+      auto const key = in.key(code);
+      auto const [rit, rin] = self.ref.insert_or_assign(key, value);
+      auto const [mit, min] = self.map.insert_or_assign(key, value);
+      expect(rin == min, "insert_or_assign", "inserted flag");
+      expect(same(self.ref, rit, self.map, mit), "insert_or_assign", "returned position");
+      break;
+    }
+
+    case op::subscript: {
+      auto const key = in.key(code);
+      if constexpr (requires { self.map[key] += value; }) {
+        self.ref[key] += value;
+        self.map[key] += value;
+      }
+      break;
+    }
+
+    case op::erase_key: {
+      auto const key = in.key(code);
+      expect(self.ref.erase(key) == self.map.erase(key), "erase(key)", "count");
+      unpin(self, key);
+      break;
+    }
+
+    case op::erase_iterator: {
+      auto const key = in.key(code);
+      if constexpr (requires { self.map.erase(self.map.find(key)); }) {
+        auto rit = self.ref.find(key);
+        auto mit = self.map.find(key);
+        expect(same(self.ref, rit, self.map, mit), "erase(iterator)", "find()");
+        if (rit == self.ref.end()) { break; }
+        auto const rnext = self.ref.erase(rit);
+        auto const mnext = self.map.erase(mit);
+        expect(same(self.ref, rnext, self.map, mnext), "erase(iterator)", "returned successor");
+        unpin(self, key);
+      }
+      break;
+    }
+
+    case op::find: {
+      auto const key = in.key(code);
+      auto const rit = self.ref.find(key);
+      auto const mit = self.map.find(key);
+      expect(same(self.ref, rit, self.map, mit), "find", "position");
+      expect(self.ref.count(key) == self.map.count(key), "count", "count");
+      expect(self.ref.contains(key) == self.map.contains(key), "contains", "result");
+      if constexpr (stable_nodes<Map>) {
+        if (mit != self.map.end()) { self.pinned = pin { key, &*mit }; }
+      }
+      break;
+    }
+
+    case op::at: {
+      auto const key = in.key(code);
+      auto const rvalue = probe([&] { return std::as_const(self.ref).at(key); });
+      auto const mvalue = probe([&] { return std::as_const(self.map).at(key); });
+      expect(rvalue == mvalue, "at", "value, or out_of_range on one side only");
+      if constexpr (requires { self.map.at(key) = value; }) {
+        if (rvalue) {
+          self.ref.at(key) = value;
+          self.map.at(key) = value;
+        }
+      }
+      break;
+    }
+
+    case op::bounds: {
+      auto const key = in.key(code);
+      expect(same(self.ref, self.ref.lower_bound(key), self.map, self.map.lower_bound(key)),
+             "lower_bound", "position");
+      expect(same(self.ref, self.ref.upper_bound(key), self.map, self.map.upper_bound(key)),
+             "upper_bound", "position");
+      break;
+    }
+
+    case op::swap: {
+      self.ref.swap(other.ref);
+      self.map.swap(other.map);
+      std::swap(self.pinned, other.pinned);
+      break;
+    }
+
+    case op::extract: {
+      auto const key = in.key(code);
+      auto const rekey = in.key(code);
+      if constexpr (requires { self.map.extract(key); }) {
+        auto rnh = self.ref.extract(key);
+        auto mnh = self.map.extract(key);
+        expect(rnh.empty() == mnh.empty(), "extract", "empty handle on one side only");
+        unpin(self, key);
+        if (rnh.empty()) { break; }
+        expect(mnh.key() == rnh.key() && mnh.mapped() == rnh.mapped(), "extract", "handle contents");
+
+        // back in under a new key, into either slot; a taken key rejects it
+        auto const * node = &mnh.mapped();
+        auto & dest = (code & 0x40) ? other : self;
+        rnh.key() = rekey;
+        mnh.key() = rekey;
+        auto const rres = dest.ref.insert(std::move(rnh));
+        auto const mres = dest.map.insert(std::move(mnh));
+        expect(rres.inserted == mres.inserted, "insert(node)", "inserted flag");
+        expect(same(dest.ref, rres.position, dest.map, mres.position), "insert(node)", "position");
+        if (mres.inserted) {
+          expect(mres.node.empty(), "insert(node)", "handle not consumed");
+          expect(&mres.position->second == node, "insert(node)", "element moved");
+        }
+        else {
+          expect(!mres.node.empty() && mres.node.key() == rekey, "insert(node)", "rejected handle lost");
+          expect(&mres.node.mapped() == node, "insert(node)", "rejected handle changed");
+        }
+      }
+      break;
+    }
+
+    case op::merge: {
+      if constexpr (requires { self.map.merge(other.map); }) {
+        self.ref.merge(other.ref);
+        self.map.merge(other.map);
+        // a pinned node that moved is followed into its new map
+        if (other.pinned && !other.ref.contains(other.pinned->key)) {
+          self.pinned = std::exchange(other.pinned, std::nullopt);
+        }
+      }
+      break;
+    }
+
+    case op::erase_if: {
+      auto const modulus = in.byte() % 5 + 1;
+      auto pred = [modulus](auto const & item) {
+        auto const & [key, mapped] = item;
+        return (key + mapped) % modulus == 0;
+      };
+      auto const rcount = std::erase_if(self.ref, pred);
+      auto const mcount = erase_matching(self.map, pred);
+      expect(rcount == mcount, "erase_if", "count");
+      if (self.pinned && !self.ref.contains(self.pinned->key)) { self.pinned.reset(); }
+      break;
+    }
+
+    case op::clear: {
+      self.ref.clear();
+      self.map.clear();
+      self.pinned.reset();
+      break;
+    }
+
+    case op::copy: {
+      if constexpr (std::copy_constructible<Map>) {
+        saved_ref_ = self.ref;
+        saved_.emplace(self.map);
+      }
+      break;
+    }
+
+    case op::restore: {
+      if constexpr (std::is_copy_assignable_v<Map>) {
+        if (!saved_) { break; }
+        self.ref = *saved_ref_;
+        self.map = *saved_;
+        self.pinned.reset();
+      }
+      break;
+    }
+
+    // fingerprinted_map::update with an fn that throws half the time,
+    //  after changing the value: the fingerprint must follow the change
+    case op::update: {
+      auto const key = in.key(code);
+      if constexpr (requires { self.map.update(key, [](int &) {}); }) {
+        auto const fails = (value & 1) != 0;
+        auto change = [value, fails](int & mapped) {
+          mapped += value;
+          if (fails) { throw std::runtime_error("update"); }
+        };
+        auto const rfound = self.ref.contains(key);
+        if (rfound) { self.ref[key] += value; }
+        auto mfound = false;
+        try { mfound = self.map.update(key, change); }
+        catch (std::runtime_error const &) { mfound = true; expect(fails, "update", "unexpected throw"); }
+        expect(rfound == mfound, "update", "found flag");
+      }
+      break;
+    }
+
+    // self's elements to other, by move construction then assignment on odd
+    //  steps, by assignment alone on even ones
+    case op::move: {
+      if constexpr (std::is_move_assignable_v<Map>) {
+        if (value & 1) {
+          auto moved = Map(std::move(self.map));
+          other.map = std::move(moved);
+        }
+        else {
+          other.map = std::move(self.map);
+        }
+        other.ref = std::move(self.ref);
+        other.pinned = std::exchange(self.pinned, std::nullopt);
+        // valid but unspecified: the reference takes whatever self still
+        //  holds, and an empty moved-from map must equal a fresh one
+        self.ref.clear();
+        for (auto it = self.map.begin(); it != self.map.end(); ++it) { self.ref.emplace(it->first, it->second); }
+        if constexpr (requires { self.map == Map {}; }) {
+          if (self.map.empty()) { expect(self.map == Map {}, "move", "empty moved-from map differs from a fresh one"); }
+        }
+      }
+      break;
+    }
+
+    // the hint is right (lower_bound), one past when the key is present
+    //  (upper_bound) or plain wrong (begin); the result must not depend on it
+    case op::emplace_hint: {
+      if constexpr (requires { self.map.emplace_hint(self.map.cbegin(), 0, 0); }) {
+        auto const key = in.key(code);
+        auto const hint = value % 3 == 0 ? self.map.lower_bound(key)
+                        : value % 3 == 1 ? self.map.upper_bound(key)
+                        :                  self.map.begin();
+        auto const rit = self.ref.try_emplace(key, value).first;
+        auto const mit = self.map.emplace_hint(hint, key, value);
+        expect(same(self.ref, rit, self.map, mit), "emplace_hint", "returned position");
+      }
+      break;
+    }
+
+    case op::nof_ops:
+      break;
+    }
+  }
+
+  auto unpin(slot & self, int key) -> void {
+    if (self.pinned && self.pinned->key == key) { self.pinned.reset(); }
+  }
+
+  auto check() -> void {
+    for (auto & self : slots_) {
+      compare(self.ref, self.map, "contents");
+      invariants(self.map);
+      if (self.pinned) {
+        auto const it = self.map.find(self.pinned->key);
+        expect(it != self.map.end() && static_cast<void const *>(&*it) == self.pinned->where,
+               "pinned element", "iterator or reference not stable");
+      }
+    }
+    // a copy must not see later updates of its original, nor they of it
+    if (saved_) { compare(*saved_ref_, *saved_, "saved copy"); }
+  }
+
+  bool                         check_each_;
+  std::array<slot, 2>          slots_;
+  std::optional<reference_map> saved_ref_;
+  std::optional<Map>           saved_;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: multi_differ
+ *  cmapmv::bucket_multimap against std::multimap: equal keys keep their
+ *  insertion order in both, so the flattened contents must match
+ *  exactly, and erase(iterator) must remove the same value and return
+ *  the same successor.
+ */
+class multi_differ {
+public:
+  using reference_map = std::multimap<int, int>;
+  using map_type      = cmapmv::bucket_multimap<int, int>;
+
+  enum class op : unsigned {
+    insert, insert_more, erase_key, erase_iterator, equal_range,
+    find, erase_if, swap, clear, shrink_to_fit,
+    nof_ops,
+  };
+
+  explicit multi_differ(bool check_each) : check_each_(check_each) {}
+
+  auto run(input & in) -> std::size_t {
+    std::size_t steps = 0;
+    for (; !in.empty(); ++steps) {
+      step_count = steps;
+      apply(in);
+      if (check_each_) { check(); }
+    }
+    check();
+    return steps;
+  }
+
+private:
+  struct slot {
+    reference_map ref;
+    map_type      map;
+  };
+
+  auto apply(input & in) -> void {
+    auto const code  = in.byte();
+    auto &     self  = slots_[code & 1];
+    auto &     other = slots_[~code & 1];
+    auto const value = static_cast<int>(step_count);
+
+    switch (static_cast<op>((code >> 1 & 0x3f) % static_cast<unsigned>(op::nof_ops))) {
+    case op::insert:
+    case op::insert_more: {
+      auto const key = in.key(code);
+      auto const rit = self.ref.emplace(key, value);
+      auto const mit = self.map.emplace(key, value);
+      expect(same(self.ref, rit, self.map, mit), "emplace", "returned position");
+      break;
+    }
+
+    case op::erase_key: {
+      auto const key = in.key(code);
+      expect(self.ref.erase(key) == self.map.erase(key), "erase(key)", "count");
+      break;
+    }
+
+    case op::erase_iterator: {
+      auto const index = in.byte();
+      if (self.ref.empty()) { break; }
+      auto const offset = static_cast<std::ptrdiff_t>(index % self.ref.size());
+      auto rit = std::next(self.ref.begin(), offset);
+      auto mit = std::next(self.map.begin(), offset);
+      expect(same(self.ref, rit, self.map, mit), "erase(iterator)", "element at index");
+      auto const rnext = self.ref.erase(rit);
+      auto const mnext = self.map.erase(mit);
+      expect(same(self.ref, rnext, self.map, mnext), "erase(iterator)", "returned successor");
+      expect(std::distance(self.map.begin(), mnext) == offset, "erase(iterator)", "successor index");
+      break;
+    }
+
+    case op::equal_range: {
+      auto const key = in.key(code);
+      auto const [first, last] = self.ref.equal_range(key);
+      auto const bucket = self.map.equal_range(key);
+      expect(std::ranges::equal(std::ranges::subrange(first, last) | std::views::values, bucket),
+             "equal_range", "values");
+      expect(self.ref.count(key) == self.map.count(key), "count", "count");
+      expect(self.ref.contains(key) == self.map.contains(key), "contains", "result");
+      break;
+    }
+
+    case op::find: {
+      auto const key = in.key(code);
+      auto const found = self.ref.find(key) != self.ref.end();
+      expect(found == (self.map.find(key) != self.map.end()), "find", "found on one side only");
+      // multimap::find may return any of the equal keys; lower_bound is exact
+      expect(same(self.ref, self.ref.lower_bound(key), self.map, self.map.lower_bound(key)),
+             "lower_bound", "position");
+      expect(same(self.ref, self.ref.upper_bound(key), self.map, self.map.upper_bound(key)),
+             "upper_bound", "position");
+      break;
+    }
+
+    case op::erase_if: {
+      auto const modulus = in.byte() % 5 + 1;
+      auto pred = [modulus](auto const & item) {
+        auto const & [key, mapped] = item;
+        return (key + mapped) % modulus == 0;
+      };
+      expect(std::erase_if(self.ref, pred) == erase_if(self.map, pred), "erase_if", "count");
+      break;
+    }
+
+    case op::swap: {
+      self.ref.swap(other.ref);
+      self.map.swap(other.map);
+      break;
+    }
+
+    case op::clear: {
+      self.ref.clear();
+      self.map.clear();
+      break;
+    }
+
+    case op::shrink_to_fit: {
+      self.map.shrink_to_fit();
+      break;
+    }
+
+    case op::nof_ops:
+      break;
+    }
+  }
+
+  auto check() -> void {
+    for (auto & self : slots_) {
+      compare(self.ref, self.map, "contents");
+      std::size_t keys = 0;
+      for (auto const & [key, bucket] : self.map.buckets()) {
+        expect(!bucket.empty(), "bucket_multimap", "empty bucket kept");
+        keys += 1;
+      }
+      expect(keys == self.map.key_count(), "bucket_multimap", "key_count()");
+    }
+  }
+
+  bool                check_each_;
+  std::array<slot, 2> slots_;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: engines
+ *  Every candidate, all instantiated as <int, int>.  replay() runs one
+ *  input through each of them in turn.
+ */
+template <class Differ>
+auto run(std::span<std::uint8_t const> data, bool check_each) -> std::size_t {
+  auto in = input(data);
+  auto differ = Differ(check_each);
+  return differ.run(in);
+}
+
+struct engine {
+  std::string_view name;
+  std::size_t (* run)(std::span<std::uint8_t const>, bool);
+};
+
+inline auto const engines = std::array {
+  engine { "cmapsm::small_map<int, int, 4>",        &run<differ<cmapsm::small_map<int, int, 4>>> },
+  engine { "cmapsm::small_map<int, int, 16>",       &run<differ<cmapsm::small_map<int, int, 16>>> },
+  engine { "cmaprec::recycling_map<int, int>",      &run<differ<cmaprec::recycling_map<int, int>>> },
+  engine { "cmapart::art_map<int, int>",            &run<differ<cmapart::art_map<int, int>>> },
+  engine { "cmapos::order_statistic_map<int, int>", &run<differ<cmapos::order_statistic_map<int, int>>> },
+  engine { "cmappm::persistent_map<int, int>",      &run<differ<cmappm::persistent_map<int, int>>> },
+  engine { "cmapfp::fingerprinted_map<int, int>",   &run<differ<cmapfp::fingerprinted_map<int, int>>> },
+  engine { "cmapmv::bucket_multimap<int, int>",     &run<multi_differ> },
+};
+
+inline auto replay(std::span<std::uint8_t const> data, bool check_each = true) -> std::size_t {
+  std::size_t steps = 0;
+  for (auto const & candidate : engines) {
+    engine_name = candidate.name;
+    steps += candidate.run(data, check_each);
+  }
+  return steps;
+}
+
+/*
+ *  MARK: edge_keys
+ *  Fixed cases the 8/16-bit random keys never reach: timeseries_map
+ *  with keys at both ends of int64_t, where delta gaps exceed INT64_MAX.
+ */
+inline auto edge_keys() -> void {
+  using limits = std::numeric_limits<std::int64_t>;
+  engine_name = "cmapts::timeseries_map<int64_t, int> edge keys";
+  auto const keys = std::array<std::int64_t, 7> {
+    limits::max(), limits::min(), 0, limits::max() - 1, -1, limits::min() + 1, 1,
+  };
+  std::map<std::int64_t, int> ref;
+  cmapts::timeseries_map<std::int64_t, int, 4> map;
+  for (std::size_t ix = 0; ix < keys.size(); ++ix) {
+    ref.try_emplace(keys[ix], static_cast<int>(ix));
+    map.try_emplace(keys[ix], static_cast<int>(ix));
+    compare(ref, map, "edge keys");
+  }
+  for (auto key : keys) {
+    expect(same(ref, ref.find(key), map, map.find(key)), "edge keys", "find");
+    expect(same(ref, ref.upper_bound(key), map, map.upper_bound(key)), "edge keys", "upper_bound");
+  }
+  map.erase(limits::min());
+  ref.erase(limits::min());
+  compare(ref, map, "edge keys after erase");
+}
+
+// a reproducible random stream
+inline auto sequence(std::uint64_t seed, std::size_t length) -> std::vector<std::uint8_t> {
+  std::mt19937_64 rng(seed);
+  std::vector<std::uint8_t> bytes(length);
+  std::ranges::generate(bytes, [&] { return static_cast<std::uint8_t>(rng()); });
+  return bytes;
+}
+
+} /* namespace fuzz */
+
+#if CMAP_LIBFUZZER
+
+//  MARK: - libFuzzer entry point.
+extern "C" int LLVMFuzzerTestOneInput(std::uint8_t const * data, std::size_t size) {
+  fuzz::replay(std::span(data, size));
+  return 0;
+}
+
+#else
+
+//  MARK: - Function Prototype.
+auto F_random(std::uint64_t runs, std::size_t length) -> void;
+auto F_seed(std::uint64_t seed, std::size_t length) -> void;
+auto F_throughput(double seconds) -> void;
+auto F_replay(std::span<char const * const> files) -> void;
+
+//  MARK: - Implementation.
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: main()
+ */
+int main(int argc, const char * argv[]) {
+  std::cout << "CF.STL_Containers_Map - differential fuzzing\n"s;
+  std::cout << "C++ Version: "s << __cplusplus << std::endl;
+
+  auto const args = std::span(argv, static_cast<std::size_t>(argc)).subspan(1);
+  auto const mode = args.empty() ? std::string_view {} : std::string_view(args[0]);
+  auto usage = [] {
+    std::cerr << "usage: map_fuzz [runs [length]]\n"
+                 "       map_fuzz --seed seed [length]\n"
+                 "       map_fuzz --throughput [seconds]\n"
+                 "       map_fuzz --replay file ...\n"s;
+  };
+  if (mode == "--help" || mode == "-h") { usage(); return 0; }
+
+  // args[ix] as an N, fallback when absent; nullopt when it does not parse
+  auto number = [&]<class N>(std::size_t ix, N fallback) -> std::optional<N> {
+    if (args.size() <= ix) { return fallback; }
+    auto const text = std::string_view(args[ix]);
+    auto value = N {};
+    auto const [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc {} || end != text.data() + text.size()) { return std::nullopt; }
+    return value;
+  };
+
+  std::cout << '\n' << konst::dlm << std::endl;
+  if (mode == "--seed") {
+    auto const seed = number(1, std::uint64_t { 0 });
+    auto const length = number(2, std::size_t { 4'096 });
+    if (!seed || !length) { usage(); return 2; }
+    F_seed(*seed, *length);
+  }
+  else if (mode == "--throughput") {
+    auto const seconds = number(1, 10.0);
+    if (!seconds) { usage(); return 2; }
+    F_throughput(*seconds);
+  }
+  else if (mode == "--replay") {
+    F_replay(args.subspan(1));
+  }
+  else {
+    auto const runs = number(0, std::uint64_t { 200 });
+    auto const length = number(1, std::size_t { 4'096 });
+    if (!runs || !length) { usage(); return 2; }
+    F_random(*runs, *length);
+  }
+
+  return 0;
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: F_random()
+ *  Seeds 0 .. runs-1, every step checked.
+ */
+auto F_random(std::uint64_t runs, std::size_t length) -> void {
+  std::cout << "random streams: "s << runs << " x "s << length << " bytes, checked every step"s << '\n';
+  fuzz::edge_keys();
+
+  std::size_t steps = 0;
+  for (std::uint64_t seed = 0; seed < runs; ++seed) {
+    fuzz::context = "rerun with --seed "s + std::to_string(seed) + ' ' + std::to_string(length);
+    steps += fuzz::replay(fuzz::sequence(seed, length));
+  }
+  std::cout << steps << " steps over "s << fuzz::engines.size() << " engines: no differences\n"s;
+  std::cout << std::endl;
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: F_seed()
+ */
+auto F_seed(std::uint64_t seed, std::size_t length) -> void {
+  std::cout << "seed "s << seed << ", "s << length << " bytes"s << '\n';
+
+  for (auto const & candidate : fuzz::engines) {
+    fuzz::engine_name = candidate.name;
+    auto const steps = candidate.run(fuzz::sequence(seed, length), true);
+    std::cout << std::left << std::setw(40) << candidate.name << std::right
+              << std::setw(8) << steps << " steps: ok\n"s;
+  }
+  std::cout << std::endl;
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: F_throughput()
+ *  Long random streams checked only at their end, round-robin over the
+ *  engines until the time is up; reports steps per second per engine,
+ *  reference map included.
+ */
+auto F_throughput(double seconds) -> void {
+  std::cout << "throughput: "s << seconds << " s, checked at the end of every stream"s << '\n';
+
+  using clock = std::chrono::steady_clock;
+  constexpr std::size_t length = 1 << 16;
+  std::vector<std::size_t> steps(fuzz::engines.size());
+  std::vector<double>      busy(fuzz::engines.size());
+
+  auto const stop = clock::now() + std::chrono::duration<double>(seconds);
+  std::uint64_t seed = 0;
+  for (; clock::now() < stop; ++seed) {
+    auto const bytes = fuzz::sequence(seed, length);
+    fuzz::context = "rerun with --seed "s + std::to_string(seed) + ' ' + std::to_string(length);
+    for (std::size_t ix = 0; ix < fuzz::engines.size(); ++ix) {
+      fuzz::engine_name = fuzz::engines[ix].name;
+      auto const start = clock::now();
+      steps[ix] += fuzz::engines[ix].run(bytes, false);
+      busy[ix] += std::chrono::duration<double>(clock::now() - start).count();
+    }
+  }
+
+  for (std::size_t ix = 0; ix < fuzz::engines.size(); ++ix) {
+    std::cout << std::left << std::setw(40) << fuzz::engines[ix].name << std::right
+              << std::fixed << std::setprecision(0) << std::setw(12)
+              << static_cast<double>(steps[ix]) / busy[ix] << " steps/s\n"s;
+  }
+  std::cout << std::defaultfloat << seed << " streams: no differences\n"s;
+  std::cout << std::endl;
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: F_replay()
+ *  Files written by libFuzzer (crash-*, the corpus) replayed as inputs.
+ */
+auto F_replay(std::span<char const * const> files) -> void {
+  std::cout << "replay: "s << files.size() << " files"s << '\n';
+
+  for (auto const * file : files) {
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs) {
+      std::cerr << "cannot open "s << file << '\n';
+      continue;
+    }
+    std::vector<std::uint8_t> bytes(std::istreambuf_iterator<char>(ifs), {});
+    fuzz::context = file;
+    auto const steps = fuzz::replay(bytes);
+    std::cout << file << ": "s << steps << " steps: ok\n"s;
+  }
+  std::cout << std::endl;
+}
+
+#endif /* CMAP_LIBFUZZER */
@@ -0,0 +1,327 @@
+//
+//  map_hints.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/container/map/emplace_hint
+//  @see: https://en.cppreference.com/w/cpp/container/map/insert (overloads 4 - 6, 10)
+//  @see: https://en.cppreference.com/w/cpp/utility/source_location
+//
+
+#ifndef map_hints_hpp
+#define map_hints_hpp
+
+#include <map>
+#include <array>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <iomanip>
+#include <source_location>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <tuple>
+#include <iterator>
+#include <initializer_list>
+#include <algorithm>
+#include <utility>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+//  CMAP_HINT_PROFILE=1 makes every hinted insert made through this
+//  header report to the hint_registry; left at 0 they forward straight
+//  to the map and checked_map is plain std::map.
+#ifndef CMAP_HINT_PROFILE
+#define CMAP_HINT_PROFILE 0
+#endif
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmaphint
+namespace cmaphint {
+
+inline constexpr bool enabled = CMAP_HINT_PROFILE != 0;
+
+/*
+ *  MARK: outcome
+ *  What a hinted insert turned out to be:
+ *    exact     - the new node went right before the hint: O(1) as the
+ *                standard guarantees;
+ *    after     - right after the hint: O(1) in libstdc++ and libc++,
+ *                not guaranteed by the standard;
+ *    miss      - anywhere else: the hint was checked, then ignored, and
+ *                a full O(log n) search followed;
+ *    duplicate - the key was present, nothing was inserted.
+ */
+enum class outcome : std::size_t { exact, after, miss, duplicate, };
+
+/*
+ *  MARK: hint_site
+ *  A hint iterator plus where it was passed.  Built implicitly from the
+ *  iterator at the call, so its default source_location argument
+ *  captures the caller's file and line, not this header's.
+ */
+template <class It>
+class hint_site {
+public:
+  template <class I>
+    requires std::convertible_to<I, It>
+  hint_site(I pos, std::source_location where = std::source_location::current()) noexcept
+    : pos_(pos), where_(where) {}
+
+  auto position() const noexcept -> It { return pos_; }
+  auto where() const noexcept -> std::source_location const & { return where_; }
+
+private:
+  It                   pos_;
+  std::source_location where_;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: hint_registry
+ *  Outcome counts per call site.  Sites are found under a mutex the
+ *  first time a thread reports from them; after that the thread keeps
+ *  a pointer to its last site, and a repeated call from the same line
+ *  (the usual loop) is a single relaxed fetch_add.
+ */
+struct site_report {
+  std::string_view file;
+  std::uint_least32_t line;
+  std::string_view function;
+  std::array<std::uint64_t, 4> counts {};
+
+  auto count(outcome what) const noexcept -> std::uint64_t {
+    return counts[static_cast<std::size_t>(what)];
+  }
+  auto calls() const noexcept -> std::uint64_t {
+    return counts[0] + counts[1] + counts[2] + counts[3];
+  }
+  // share of inserts that took an O(1) path (exact or after)
+  auto accuracy() const noexcept -> double {
+    auto const inserts = calls() - count(outcome::duplicate);
+    return inserts == 0 ? 1.0
+         : static_cast<double>(count(outcome::exact) + count(outcome::after)) / static_cast<double>(inserts);
+  }
+};
+
+class hint_registry {
+public:
+  static auto instance() -> hint_registry & {
+    static hint_registry registry;
+    return registry;
+  }
+
+  auto record(std::source_location const & where, outcome what) -> void {
+    thread_local struct {
+      hint_registry const * owner = nullptr;
+      char const *          file  = nullptr;
+      std::uint_least32_t   line  = 0;
+      std::uint_least32_t   column = 0;
+      counters *            site  = nullptr;
+    } last;
+    if (last.owner != this || last.file != where.file_name()
+     || last.line != where.line() || last.column != where.column()) {
+      last = { this, where.file_name(), where.line(), where.column(), lookup(where) };
+    }
+    last.site->counts[static_cast<std::size_t>(what)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // every site called since the last reset(), those with most misses first
+  auto report() const -> std::vector<site_report> {
+    std::vector<site_report> out;
+    {
+      auto lock = std::scoped_lock(mx_);
+      for (auto const & [key, site] : sites_) {
+        site_report row { site->file, site->line, site->function };
+        for (std::size_t ix = 0; ix < row.counts.size(); ++ix) {
+          row.counts[ix] = site->counts[ix].load(std::memory_order_relaxed);
+        }
+        if (row.calls() != 0) { out.push_back(row); }
+      }
+    }
+    std::stable_sort(out.begin(), out.end(), [](auto const & lhs, auto const & rhs) {
+      return lhs.count(outcome::miss) > rhs.count(outcome::miss);
+    });
+    return out;
+  }
+
+  // zero the counts; sites stay registered, so cached pointers stay
+  //  valid, but drop out of report() until they are called again
+  auto reset() -> void {
+    auto lock = std::scoped_lock(mx_);
+    for (auto & [key, site] : sites_) {
+      for (auto & count : site->counts) { count.store(0, std::memory_order_relaxed); }
+    }
+  }
+
+  friend auto operator<<(std::ostream & os, hint_registry const & registry) -> std::ostream & {
+    for (auto const & row : registry.report()) {
+      auto const slash = row.file.find_last_of("/\\");
+      auto const file = slash == std::string_view::npos ? row.file : row.file.substr(slash + 1);
+      os << std::left << std::setw(20) << std::string(file) + ':' + std::to_string(row.line) << std::right
+         << "  calls " << std::setw(8) << row.calls()
+         << "  exact " << std::setw(8) << row.count(outcome::exact)
+         << "  after " << std::setw(8) << row.count(outcome::after)
+         << "  miss " << std::setw(8) << row.count(outcome::miss)
+         << "  dup " << std::setw(6) << row.count(outcome::duplicate)
+         << "  O(1): " << std::fixed << std::setprecision(1) << std::setw(5)
+         << row.accuracy() * 100.0 << '%' << std::defaultfloat << std::setprecision(6)
+         << "  in " << row.function << '\n';
+    }
+    return os;
+  }
+
+private:
+  struct counters {
+    std::string_view    file;
+    std::uint_least32_t line;
+    std::string_view    function;
+    std::array<std::atomic<std::uint64_t>, 4> counts {};
+  };
+  using site_key = std::tuple<std::string_view, std::uint_least32_t, std::uint_least32_t>;
+
+  auto lookup(std::source_location const & where) -> counters * {
+    auto lock = std::scoped_lock(mx_);
+    auto & site = sites_[site_key(where.file_name(), where.line(), where.column())];
+    if (!site) {
+      site = std::make_unique<counters>();
+      site->file = where.file_name();
+      site->line = where.line();
+      site->function = where.function_name();
+    }
+    return site.get();
+  }
+
+  mutable std::mutex                            mx_;
+  std::map<site_key, std::unique_ptr<counters>> sites_;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: hinted inserts
+ *  Drop-in for map.emplace_hint(hint, ...), map.insert(hint, value) and
+ *  map.insert(hint, std::move(nh)): cmaphint::emplace_hint(map, hint,
+ *  ...) and so on.  The outcome is read off the result afterwards, so
+ *  profiling adds two O(1) iterator steps and no search.
+ */
+template <class Map>
+auto classify(Map const & map, typename Map::const_iterator hint,
+              typename Map::const_iterator result, bool inserted) -> outcome {
+  if (!inserted)                                          { return outcome::duplicate; }
+  if (std::next(result) == hint)                          { return outcome::exact; }
+  if (result != map.begin() && std::prev(result) == hint) { return outcome::after; }
+  return outcome::miss;
+}
+
+template <bool Profile = enabled, class Map, class Insert>
+auto profiled(Map & map, hint_site<typename Map::const_iterator> const & hint, Insert && insert)
+-> typename Map::iterator {
+  if constexpr (!Profile) {
+    return insert(hint.position());
+  }
+  else {
+    auto const size = map.size();
+    auto const result = insert(hint.position());
+    hint_registry::instance().record(hint.where(),
+                                     classify(map, hint.position(), result, map.size() != size));
+    return result;
+  }
+}
+
+template <class Map, class ... Args>
+auto emplace_hint(Map & map, hint_site<typename Map::const_iterator> hint, Args && ... args)
+-> typename Map::iterator {
+  return profiled(map, hint, [&](auto pos) { return map.emplace_hint(pos, std::forward<Args>(args) ...); });
+}
+
+template <class Map>
+auto insert(Map & map, hint_site<typename Map::const_iterator> hint, typename Map::value_type const & value)
+-> typename Map::iterator {
+  return profiled(map, hint, [&](auto pos) { return map.insert(pos, value); });
+}
+
+template <class Map>
+auto insert(Map & map, hint_site<typename Map::const_iterator> hint, typename Map::value_type && value)
+-> typename Map::iterator {
+  return profiled(map, hint, [&](auto pos) { return map.insert(pos, std::move(value)); });
+}
+
+// an empty or rejected handle counts as a duplicate
+template <class Map>
+auto insert(Map & map, hint_site<typename Map::const_iterator> hint, typename Map::node_type && nh)
+-> typename Map::iterator {
+  return profiled(map, hint, [&](auto pos) { return map.insert(pos, std::move(nh)); });
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: profiled_map
+ *  std::map whose hinted inserts always report, so existing
+ *  map.emplace_hint(it, ...) calls are profiled by changing only the
+ *  declaration.  checked_map is profiled_map with CMAP_HINT_PROFILE=1
+ *  and std::map otherwise.  Never delete one
+ *  through a std::map pointer.
+ */
+template <class Key, class T,
+          class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<Key const, T>>>
+class profiled_map : public std::map<Key, T, Compare, Allocator> {
+  using base = std::map<Key, T, Compare, Allocator>;
+
+public:
+  using typename base::iterator;
+  using typename base::const_iterator;
+  using typename base::value_type;
+  using typename base::node_type;
+  using typename base::insert_return_type;
+  using hint_type = hint_site<const_iterator>;
+
+  using base::base;
+
+  template <class ... Args>
+  auto emplace_hint(hint_type hint, Args && ... args) -> iterator {
+    auto & self = as_base();
+    return profiled<true>(self, hint, [&self, &args ...](const_iterator pos) {
+      return self.emplace_hint(pos, std::forward<Args>(args) ...);
+    });
+  }
+
+  auto insert(hint_type hint, value_type const & value) -> iterator {
+    auto & self = as_base();
+    return profiled<true>(self, hint, [&](const_iterator pos) { return self.insert(pos, value); });
+  }
+  auto insert(hint_type hint, value_type && value) -> iterator {
+    auto & self = as_base();
+    return profiled<true>(self, hint, [&](const_iterator pos) { return self.insert(pos, std::move(value)); });
+  }
+  auto insert(hint_type hint, node_type && nh) -> iterator {
+    auto & self = as_base();
+    return profiled<true>(self, hint, [&](const_iterator pos) { return self.insert(pos, std::move(nh)); });
+  }
+
+  // the unhinted overloads, unchanged
+  auto insert(value_type const & value) { return base::insert(value); }
+  auto insert(value_type && value) { return base::insert(std::move(value)); }
+  template <std::input_iterator It>
+  auto insert(It first, It last) -> void { base::insert(first, last); }
+  auto insert(std::initializer_list<value_type> init) -> void { base::insert(init); }
+  auto insert(node_type && nh) -> insert_return_type { return base::insert(std::move(nh)); }
+
+private:
+  auto as_base() noexcept -> base & { return *this; }
+};
+
+template <class Key, class T,
+          class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<Key const, T>>>
+using checked_map = std::conditional_t<enabled,
+                                       profiled_map<Key, T, Compare, Allocator>,
+                                       std::map<Key, T, Compare, Allocator>>;
+
+} /* namespace cmaphint */
+
+#endif /* map_hints_hpp */
@@ -0,0 +1,453 @@
+//
+//  map_instrument.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: Metwally, Agrawal & El Abbadi, "Efficient Computation of Frequent
+//        and Top-k Elements in Data Streams" (Space-Saving)
+//  @see: https://en.cppreference.com/w/cpp/chrono/steady_clock
+//
+
+#ifndef map_instrument_hpp
+#define map_instrument_hpp
+
+#include <map>
+#include <array>
+#include <vector>
+#include <string_view>
+#include <ostream>
+#include <iomanip>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <stop_token>
+#include <memory>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include <bit>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+//  CMAP_INSTRUMENT=1 turns cmapinst::traced_map into the instrumented
+//  wrapper; left at 0 it is plain std::map and costs nothing.
+#ifndef CMAP_INSTRUMENT
+#define CMAP_INSTRUMENT 0
+#endif
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapinst
+namespace cmapinst {
+
+inline constexpr bool enabled = CMAP_INSTRUMENT != 0;
+
+enum class op : std::size_t { find, at, subscript, emplace_hint, erase, };
+inline constexpr std::size_t op_count = 5;
+inline constexpr std::array<std::string_view, op_count> op_names {
+  "find", "at", "operator[]", "emplace_hint", "erase",
+};
+
+/*
+ *  MARK: latency_histogram
+ *  Power-of-two buckets of nanoseconds: bucket b counts calls that took
+ *  [2^(b-1), 2^b) ns, bucket 0 those under 1 ns.  Recording is one
+ *  relaxed fetch_add, so any thread may record and read concurrently.
+ */
+class latency_histogram {
+public:
+  static constexpr std::size_t buckets = 40;
+
+  auto record(std::uint64_t nanos) noexcept -> void {
+    auto const bucket = std::min<std::size_t>(std::bit_width(nanos), buckets - 1);
+    counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+    calls_.fetch_add(1, std::memory_order_relaxed);
+    total_.fetch_add(nanos, std::memory_order_relaxed);
+  }
+
+  auto calls() const noexcept -> std::uint64_t { return calls_.load(std::memory_order_relaxed); }
+  auto total_nanos() const noexcept -> std::uint64_t { return total_.load(std::memory_order_relaxed); }
+  auto count(std::size_t bucket) const noexcept -> std::uint64_t {
+    return counts_[bucket].load(std::memory_order_relaxed);
+  }
+
+private:
+  std::array<std::atomic<std::uint64_t>, buckets> counts_ {};
+  std::atomic<std::uint64_t> calls_ { 0 };
+  std::atomic<std::uint64_t> total_ { 0 };
+};
+
+/*
+ *  MARK: space_saving
+ *  Top-K heavy hitters over a stream of keys in K counters.  A key not
+ *  yet tracked evicts the smallest counter and inherits its count as
+ *  error: every key whose true frequency exceeds n / K is kept, and
+ *  count - error is a lower bound on its frequency.
+ */
+template <class Key>
+struct hot_key {
+  Key           key;
+  std::uint64_t count;
+  std::uint64_t error;
+};
+
+template <class Key>
+class space_saving {
+public:
+  explicit space_saving(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {
+    slots_.reserve(capacity_);
+  }
+
+  auto offer(Key const & key) -> void {
+    auto hit = std::find_if(slots_.begin(), slots_.end(), [&key](auto const & slot) {
+      return slot.key == key;
+    });
+    if (hit != slots_.end()) { ++hit->count; return; }
+    if (slots_.size() < capacity_) { slots_.push_back({ key, 1, 0 }); return; }
+    auto low = std::min_element(slots_.begin(), slots_.end(), [](auto const & lhs, auto const & rhs) {
+      return lhs.count < rhs.count;
+    });
+    *low = { key, low->count + 1, low->count };
+  }
+
+  // most frequent first, by the guaranteed count (count - error) that
+  //  operator<< prints; count breaks ties
+  auto top() const -> std::vector<hot_key<Key>> {
+    auto out = slots_;
+    std::sort(out.begin(), out.end(), [](auto const & lhs, auto const & rhs) {
+      auto const lsure = lhs.count - lhs.error;
+      auto const rsure = rhs.count - rhs.error;
+      return lsure != rsure ? lsure > rsure : lhs.count > rhs.count;
+    });
+    return out;
+  }
+
+private:
+  std::vector<hot_key<Key>> slots_;
+  std::size_t               capacity_;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: map_stats
+ *  Counters for one map, or for several sharing one map_stats:
+ *    - calls and a latency_histogram per operation;
+ *    - at() calls that threw out_of_range;
+ *    - emplace_hint() calls whose hint held, the new key landing right
+ *      before or right after it (both O(1)), or was wrong;
+ *    - a space_saving sketch fed with one key in sample_every, at random.
+ *  Everything but the sketch is atomic and read without a lock.  The
+ *  sketch sits behind a mutex that the map only ever try_locks, so a
+ *  contended sample is dropped (and counted) instead of waited for.
+ */
+template <class Key>
+class map_stats {
+public:
+  struct options {
+    std::size_t top_k        = 16;
+    std::size_t sample_every = 16;
+  };
+
+  struct op_snapshot {
+    std::uint64_t calls       = 0;
+    std::uint64_t total_nanos = 0;
+    std::array<std::uint64_t, latency_histogram::buckets> histogram {};
+
+    auto mean_nanos() const noexcept -> double {
+      return calls == 0 ? 0.0 : static_cast<double>(total_nanos) / static_cast<double>(calls);
+    }
+    // upper edge of the bucket holding the p-th quantile, 0 <= p <= 1
+    auto quantile_nanos(double p) const noexcept -> std::uint64_t {
+      auto const rank = static_cast<std::uint64_t>(p * static_cast<double>(calls));
+      std::uint64_t seen = 0;
+      for (std::size_t bucket = 0; bucket < histogram.size(); ++bucket) {
+        seen += histogram[bucket];
+        if (seen > rank || seen == calls) { return std::uint64_t { 1 } << bucket; }
+      }
+      return 0;
+    }
+  };
+
+  struct snapshot {
+    std::array<op_snapshot, op_count> ops {};
+    std::uint64_t at_throws     = 0;
+    std::uint64_t hint_hits     = 0;   // O(1) inserts: right before the hint, or after it
+    std::uint64_t hint_after    = 0;   // of which right after it
+    std::uint64_t hint_misses   = 0;
+    std::uint64_t samples_lost  = 0;
+    std::vector<hot_key<Key>> hot_keys;
+
+    auto operator[](op which) const -> op_snapshot const & {
+      return ops[static_cast<std::size_t>(which)];
+    }
+
+    // one line per operation that was called, then the hot keys
+    friend auto operator<<(std::ostream & os, snapshot const & snap) -> std::ostream & {
+      for (std::size_t ix = 0; ix < op_count; ++ix) {
+        auto const & ops = snap.ops[ix];
+        if (ops.calls == 0) { continue; }
+        os << std::left << std::setw(14) << op_names[ix] << std::right
+           << std::setw(8) << ops.calls << " calls, mean "
+           << std::fixed << std::setprecision(0) << std::setw(6) << ops.mean_nanos() << " ns, p50 <"
+           << std::setw(6) << ops.quantile_nanos(0.50) << " ns, p99 <"
+           << std::setw(7) << ops.quantile_nanos(0.99) << " ns\n"
+           << std::defaultfloat << std::setprecision(6);
+      }
+      os << "at() throws: " << snap.at_throws
+         << ", emplace_hint O(1)/wrong: " << snap.hint_hits << '/' << snap.hint_misses
+         << " (" << snap.hint_after << " after the hint)\n";
+      os << "hot keys (count - error):";
+      for (auto const & hot : snap.hot_keys) {
+        os << ' ' << hot.key << " (" << hot.count - hot.error << ')';
+      }
+      return os << '\n';
+    }
+  };
+
+  map_stats() : map_stats(options {}) {}
+  explicit map_stats(options opts) : opts_(opts), sketch_(opts.top_k) {}
+
+  map_stats(map_stats const &) = delete;
+  auto operator=(map_stats const &) -> map_stats & = delete;
+
+  // where instrumented maps with this key type report unless told otherwise
+  static auto global() -> std::shared_ptr<map_stats> const & {
+    static auto const stats = std::make_shared<map_stats>();
+    return stats;
+  }
+
+  auto record(op which, std::uint64_t nanos) noexcept -> void {
+    histograms_[static_cast<std::size_t>(which)].record(nanos);
+  }
+
+  auto record_throw() noexcept -> void { at_throws_.fetch_add(1, std::memory_order_relaxed); }
+  // exact: the node went right before the hint; after: right after it.
+  //  Both are O(1) in libstdc++ and libc++, as map_hints.hpp counts them
+  auto record_hint(bool exact, bool after) noexcept -> void {
+    (exact || after ? hint_hits_ : hint_misses_).fetch_add(1, std::memory_order_relaxed);
+    if (after) { hint_after_.fetch_add(1, std::memory_order_relaxed); }
+  }
+
+  auto sample(Key const & key) -> void {
+    // xorshift, not a plain counter: a fixed stride would lock onto
+    // whichever call of a repeating pattern it first lands on
+    thread_local std::uint32_t state = 0x9e37'79b9u;
+    state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+    if (state % opts_.sample_every != 0) { return; }
+    auto lock = std::unique_lock(sketch_mx_, std::try_to_lock);
+    if (!lock) { samples_lost_.fetch_add(1, std::memory_order_relaxed); return; }
+    sketch_.offer(key);
+  }
+
+  auto take_snapshot() const -> snapshot {
+    snapshot snap;
+    for (std::size_t ix = 0; ix < op_count; ++ix) {
+      auto const & hist = histograms_[ix];
+      auto & out = snap.ops[ix];
+      out.calls = hist.calls();
+      out.total_nanos = hist.total_nanos();
+      for (std::size_t bucket = 0; bucket < latency_histogram::buckets; ++bucket) {
+        out.histogram[bucket] = hist.count(bucket);
+      }
+    }
+    snap.at_throws    = at_throws_.load(std::memory_order_relaxed);
+    snap.hint_hits    = hint_hits_.load(std::memory_order_relaxed);
+    snap.hint_after   = hint_after_.load(std::memory_order_relaxed);
+    snap.hint_misses  = hint_misses_.load(std::memory_order_relaxed);
+    snap.samples_lost = samples_lost_.load(std::memory_order_relaxed);
+    {
+      auto lock = std::scoped_lock(sketch_mx_);
+      snap.hot_keys = sketch_.top();
+    }
+    return snap;
+  }
+
+  auto sample_every() const noexcept -> std::size_t { return opts_.sample_every; }
+
+private:
+  options                                    opts_;
+  std::array<latency_histogram, op_count>    histograms_ {};
+  std::atomic<std::uint64_t>                 at_throws_    { 0 };
+  std::atomic<std::uint64_t>                 hint_hits_    { 0 };
+  std::atomic<std::uint64_t>                 hint_after_   { 0 };
+  std::atomic<std::uint64_t>                 hint_misses_  { 0 };
+  std::atomic<std::uint64_t>                 samples_lost_ { 0 };
+  mutable std::mutex                         sketch_mx_;
+  space_saving<Key>                          sketch_;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: instrumented_map
+ *  std::map with find, at, operator[], emplace_hint and erase timed and
+ *  counted into a map_stats: map_stats<Key>::global() unless one is
+ *  passed in, so by default every map with the same key type adds to
+ *  the same figures.  All other members are std::map's own; copies
+ *  report where their original does.  Derives from std::map only to
+ *  inherit its interface: never delete one through a std::map pointer.
+ */
+template <class Key, class T,
+          class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<Key const, T>>>
+class instrumented_map : public std::map<Key, T, Compare, Allocator> {
+  using base  = std::map<Key, T, Compare, Allocator>;
+  using clock = std::chrono::steady_clock;
+
+public:
+  using typename base::iterator;
+  using typename base::const_iterator;
+  using typename base::size_type;
+  using stats_type = map_stats<Key>;
+
+  using base::base;
+
+  instrumented_map() = default;
+  explicit instrumented_map(std::shared_ptr<stats_type> stats) : stats_(std::move(stats)) {}
+
+  auto stats() const noexcept -> stats_type & { return *stats_; }
+  auto shared_stats() const noexcept -> std::shared_ptr<stats_type> { return stats_; }
+
+  //  MARK: traced operations
+  auto find(Key const & key) -> iterator {
+    return timed(op::find, key, [&] { return base::find(key); });
+  }
+  auto find(Key const & key) const -> const_iterator {
+    return timed(op::find, key, [&] { return base::find(key); });
+  }
+
+  auto at(Key const & key) -> T & { return traced_at(*this, key); }
+  auto at(Key const & key) const -> T const & { return traced_at(*this, key); }
+
+  auto operator[](Key const & key) -> T & {
+    return timed(op::subscript, key, [&]() -> T & { return base::operator[](key); });
+  }
+  auto operator[](Key && key) -> T & {
+    stats_->sample(key);
+    auto const start = clock::now();
+    auto & mapped = base::operator[](std::move(key));
+    stats_->record(op::subscript, elapsed(start));
+    return mapped;
+  }
+
+  template <class ... Args>
+  auto emplace_hint(const_iterator hint, Args && ... args) -> iterator {
+    auto const start = clock::now();
+    auto const size = base::size();
+    auto const it = base::emplace_hint(hint, std::forward<Args>(args) ...);
+    stats_->record(op::emplace_hint, elapsed(start));
+    if (base::size() != size) {
+      auto const exact = std::next(it) == hint;
+      stats_->record_hint(exact, !exact && it != base::begin() && std::prev(it) == hint);
+    }
+    stats_->sample(it->first);
+    return it;
+  }
+
+  auto erase(Key const & key) -> size_type {
+    return timed(op::erase, key, [&] { return base::erase(key); });
+  }
+  auto erase(const_iterator pos) -> iterator {
+    stats_->sample(pos->first);
+    auto const start = clock::now();
+    auto const next = base::erase(pos);
+    stats_->record(op::erase, elapsed(start));
+    return next;
+  }
+  auto erase(iterator pos) -> iterator { return erase(const_iterator(pos)); }
+  auto erase(const_iterator first, const_iterator last) -> iterator {
+    auto const start = clock::now();
+    auto const next = base::erase(first, last);
+    stats_->record(op::erase, elapsed(start));
+    return next;
+  }
+
+private:
+  static auto elapsed(clock::time_point start) noexcept -> std::uint64_t {
+    return static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+  }
+
+  template <class Fn>
+  auto timed(op which, Key const & key, Fn && fn) const -> decltype(auto) {
+    stats_->sample(key);
+    auto const start = clock::now();
+    decltype(auto) result = fn();
+    stats_->record(which, elapsed(start));
+    return static_cast<decltype(result)>(result);
+  }
+
+  template <class Self>
+  static auto traced_at(Self & self, Key const & key) -> decltype(auto) {
+    self.stats_->sample(key);
+    auto const start = clock::now();
+    try {
+      decltype(auto) mapped = self.base::at(key);
+      self.stats_->record(op::at, elapsed(start));
+      return static_cast<decltype(mapped)>(mapped);
+    }
+    catch (std::out_of_range const &) {
+      self.stats_->record(op::at, elapsed(start));
+      self.stats_->record_throw();
+      throw;
+    }
+  }
+
+  std::shared_ptr<stats_type> stats_ = stats_type::global();
+};
+
+/*
+ *  MARK: traced_map
+ *  What code under measurement should name: instrumented_map when built
+ *  with CMAP_INSTRUMENT=1, otherwise std::map itself, so a disabled
+ *  build runs exactly the uninstrumented code.
+ */
+template <class Key, class T,
+          class Compare = std::less<Key>,
+          class Allocator = std::allocator<std::pair<Key const, T>>>
+using traced_map = std::conditional_t<enabled,
+                                      instrumented_map<Key, T, Compare, Allocator>,
+                                      std::map<Key, T, Compare, Allocator>>;
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: periodic_dump
+ *  Calls dump() every interval on a background thread, and once more
+ *  when destroyed, e.g. to print a map_stats snapshot to a log.
+ */
+class periodic_dump {
+public:
+  template <class Rep, class Period>
+  periodic_dump(std::chrono::duration<Rep, Period> interval, std::function<void()> dump)
+    : dump_(std::move(dump)),
+      thread_([this, interval](std::stop_token stop) {
+        auto lock = std::unique_lock(mx_);
+        for (;;) {
+          cv_.wait_for(lock, stop, interval, [] { return false; });
+          if (stop.stop_requested()) { return; }
+          dump_();
+        }
+      }) {}
+
+  periodic_dump(periodic_dump const &) = delete;
+  auto operator=(periodic_dump const &) -> periodic_dump & = delete;
+
+  ~periodic_dump() {
+    thread_.request_stop();
+    thread_.join();
+    dump_();
+  }
+
+private:
+  std::function<void()>       dump_;
+  std::mutex                  mx_;
+  std::condition_variable_any cv_;
+  std::jthread                thread_;   // last: started once the rest exists
+};
+
+} /* namespace cmapinst */
+
+#endif /* map_instrument_hpp */
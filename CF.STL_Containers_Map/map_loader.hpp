@@ -0,0 +1,481 @@
+//
+//  map_loader.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/language/coroutines
+//  @see: Lewis Baker, "C++ Coroutines: Understanding Symmetric Transfer"
+//  @see: https://en.cppreference.com/w/cpp/container/map/emplace_hint
+//
+
+#ifndef map_loader_hpp
+#define map_loader_hpp
+
+#include <coroutine>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <latch>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <exception>
+#include <stdexcept>
+#include <stop_token>
+#include <functional>
+#include <deque>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+#include "map_parallel.hpp"
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapio
+namespace cmapio {
+
+/*
+ *  MARK: task<T>
+ *  Lazily started coroutine producing a T.  co_await starts it and
+ *  resumes the awaiter, by symmetric transfer, when it finishes.
+ */
+template <class T>
+class task {
+public:
+  struct promise_type {
+    std::optional<T>        value;
+    std::exception_ptr      error;
+    std::coroutine_handle<> continuation;
+
+    auto get_return_object() -> task {
+      return task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+
+    struct final_awaiter {
+      auto await_ready() noexcept -> bool { return false; }
+      auto await_suspend(std::coroutine_handle<promise_type> self) noexcept
+      -> std::coroutine_handle<> {
+        auto next = self.promise().continuation;
+        return next ? next : std::noop_coroutine();
+      }
+      auto await_resume() noexcept -> void {}
+    };
+    auto final_suspend() noexcept -> final_awaiter { return {}; }
+
+    template <class V>
+    auto return_value(V && result) -> void { value.emplace(std::forward<V>(result)); }
+    auto unhandled_exception() noexcept -> void { error = std::current_exception(); }
+  };
+
+  task(task && other) noexcept : coro_(std::exchange(other.coro_, {})) {}
+  task(task const &) = delete;
+  auto operator=(task) -> task & = delete;
+  ~task() { if (coro_) { coro_.destroy(); } }
+
+  auto operator co_await() && {
+    struct awaiter {
+      std::coroutine_handle<promise_type> coro;
+
+      auto await_ready() const noexcept -> bool { return false; }
+      auto await_suspend(std::coroutine_handle<> caller) noexcept -> std::coroutine_handle<> {
+        coro.promise().continuation = caller;
+        return coro;
+      }
+      auto await_resume() -> T {
+        if (coro.promise().error) { std::rethrow_exception(coro.promise().error); }
+        return std::move(*coro.promise().value);
+      }
+    };
+    return awaiter { coro_ };
+  }
+
+private:
+  explicit task(std::coroutine_handle<promise_type> coro) : coro_(coro) {}
+
+  std::coroutine_handle<promise_type> coro_;
+};
+
+namespace detail {
+
+// coroutine that starts at once and frees itself when done
+struct detached {
+  struct promise_type {
+    auto get_return_object() noexcept -> detached { return {}; }
+    auto initial_suspend() noexcept -> std::suspend_never { return {}; }
+    auto final_suspend() noexcept -> std::suspend_never { return {}; }
+    auto return_void() noexcept -> void {}
+    auto unhandled_exception() noexcept -> void { std::terminate(); }
+  };
+};
+
+/*
+ *  Result slot of an eagerly started job: set once by the producer,
+ *  awaited by at most one coroutine, or waited on by a thread.
+ */
+template <class T>
+struct job_state {
+  std::mutex              mx;
+  std::condition_variable cv;
+  std::optional<T>        value;
+  std::exception_ptr      error;
+  std::coroutine_handle<> waiter;
+  bool                    done = false;
+
+  template <class Fn>
+  auto complete(Fn && produce) -> void {
+    std::optional<T> result;
+    std::exception_ptr failure;
+    try { result.emplace(std::invoke(std::forward<Fn>(produce))); }
+    catch (...) { failure = std::current_exception(); }
+
+    std::coroutine_handle<> next;
+    {
+      auto lock = std::scoped_lock(mx);
+      value = std::move(result);
+      error = failure;
+      done = true;
+      next = std::exchange(waiter, {});
+    }
+    cv.notify_all();
+    if (next) { next.resume(); }
+  }
+};
+
+template <class T>
+auto drive(task<T> work, std::shared_ptr<job_state<T>> state) -> detached {
+  std::optional<T> result;
+  std::exception_ptr failure;
+  try { result.emplace(co_await std::move(work)); }
+  catch (...) { failure = std::current_exception(); }
+  state->complete([&]() -> T {
+    if (failure) { std::rethrow_exception(failure); }
+    return std::move(*result);
+  });
+}
+
+template <class T>
+auto signal(task<T> & work, std::optional<T> & result, std::exception_ptr & failure,
+            std::latch & finished) -> detached {
+  try { result.emplace(co_await std::move(work)); }
+  catch (...) { failure = std::current_exception(); }
+  finished.count_down();
+}
+
+} /* namespace detail */
+
+/*
+ *  MARK: job<T>
+ *  Handle to work already running elsewhere.  co_await suspends until
+ *  the value is ready (resuming on the producing thread); get() blocks.
+ */
+template <class T>
+class job {
+public:
+  explicit job(std::shared_ptr<detail::job_state<T>> state) : state_(std::move(state)) {}
+
+  auto await_ready() const -> bool {
+    auto lock = std::scoped_lock(state_->mx);
+    return state_->done;
+  }
+  auto await_suspend(std::coroutine_handle<> caller) -> bool {
+    auto lock = std::scoped_lock(state_->mx);
+    if (state_->done) { return false; }
+    state_->waiter = caller;
+    return true;
+  }
+  auto await_resume() -> T {
+    if (state_->error) { std::rethrow_exception(state_->error); }
+    return std::move(*state_->value);
+  }
+
+  auto get() -> T {
+    {
+      auto lock = std::unique_lock(state_->mx);
+      state_->cv.wait(lock, [this] { return state_->done; });
+    }
+    return await_resume();
+  }
+
+private:
+  std::shared_ptr<detail::job_state<T>> state_;
+};
+
+template <class T>
+auto sync_wait(task<T> work) -> T {
+  std::optional<T> result;
+  std::exception_ptr failure;
+  std::latch finished(1);
+  detail::signal(work, result, failure, finished);
+  finished.wait();
+  if (failure) { std::rethrow_exception(failure); }
+  return std::move(*result);
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: thread_pool
+ *  Fixed set of workers draining one FIFO queue.  submit() runs a
+ *  callable and returns a job for its result; schedule() is an
+ *  awaitable that moves the awaiting coroutine onto a worker.  Stands in
+ *  for io_uring as the I/O backend: a blocking read occupies one worker
+ *  while the others parse.
+ */
+class thread_pool {
+public:
+  explicit thread_pool(unsigned threads = cmappar::default_threads()) {
+    threads = std::max(threads, 1u);
+    workers_.reserve(threads);
+    for (unsigned ix = 0; ix < threads; ++ix) {
+      workers_.emplace_back([this](std::stop_token stop) { work(stop); });
+    }
+  }
+
+  thread_pool(thread_pool const &) = delete;
+  auto operator=(thread_pool const &) -> thread_pool & = delete;
+
+  // queued work is finished first; the jthreads stop and join
+  ~thread_pool() = default;
+
+  auto size() const noexcept -> std::size_t { return workers_.size(); }
+
+  auto post(std::function<void()> fn) -> void {
+    {
+      auto lock = std::scoped_lock(mx_);
+      queue_.push_back(std::move(fn));
+    }
+    ready_.notify_one();
+  }
+
+  template <class Fn>
+  auto submit(Fn fn) -> job<std::invoke_result_t<Fn &>> {
+    using result_type = std::invoke_result_t<Fn &>;
+    auto state = std::make_shared<detail::job_state<result_type>>();
+    post([state, fn = std::move(fn)]() mutable { state->complete(fn); });
+    return job<result_type>(state);
+  }
+
+  // start a task now; the job yields its result
+  template <class T>
+  auto spawn(task<T> work) -> job<T> {
+    auto state = std::make_shared<detail::job_state<T>>();
+    post([state, work = std::make_shared<task<T>>(std::move(work))]() mutable {
+      detail::drive(std::move(*work), state);
+    });
+    return job<T>(state);
+  }
+
+  auto schedule() {
+    struct awaiter {
+      thread_pool * pool;
+      auto await_ready() const noexcept -> bool { return false; }
+      auto await_suspend(std::coroutine_handle<> caller) -> void {
+        pool->post([caller] { caller.resume(); });
+      }
+      auto await_resume() const noexcept -> void {}
+    };
+    return awaiter { this };
+  }
+
+private:
+  auto work(std::stop_token stop) -> void {
+    for (;;) {
+      std::function<void()> fn;
+      {
+        auto lock = std::unique_lock(mx_);
+        ready_.wait(lock, stop, [this] { return !queue_.empty(); });
+        if (queue_.empty()) { return; }  // stopping, and drained
+        fn = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      fn();
+    }
+  }
+
+  std::mutex                        mx_;
+  std::condition_variable_any       ready_;
+  std::deque<std::function<void()>> queue_;
+  std::vector<std::jthread>         workers_;  // last: joined before the queue dies
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: load_map()
+ *  Pipelined load of a line-oriented file into Map.  One coroutine
+ *  drives three overlapped stages on the pool:
+ *    - read:   chunk_bytes at a time, the next read in flight while the
+ *              current chunk is handed on;
+ *    - parse:  each chunk of whole lines becomes a run of value_type,
+ *              stably sorted by key; up to parse_depth runs in flight;
+ *    - insert: runs are inserted in file order by the coroutine alone,
+ *              each with emplace_hint chained from the previous element.
+ *  parse(std::string_view line) returns std::optional<Map::value_type>;
+ *  std::nullopt skips the line.  As with the initializer-list
+ *  constructors, the first occurrence of a key wins.
+ */
+struct load_progress {
+  std::size_t bytes_total      = 0;
+  std::size_t bytes_read       = 0;
+  std::size_t records_parsed   = 0;
+  std::size_t records_inserted = 0;
+
+  auto fraction() const noexcept -> double {
+    return bytes_total == 0 ? 1.0
+                            : static_cast<double>(bytes_read) / static_cast<double>(bytes_total);
+  }
+};
+
+struct load_options {
+  std::size_t chunk_bytes = 1 << 20;
+  unsigned    parse_depth = 2 * cmappar::default_threads();
+  std::function<void(load_progress const &)> on_progress;  // after each run
+};
+
+namespace detail {
+
+struct load_counters {
+  std::atomic<std::size_t> bytes_total      { 0 };
+  std::atomic<std::size_t> bytes_read       { 0 };
+  std::atomic<std::size_t> records_parsed   { 0 };
+  std::atomic<std::size_t> records_inserted { 0 };
+
+  auto snapshot() const -> load_progress {
+    return { bytes_total.load(), bytes_read.load(), records_parsed.load(), records_inserted.load() };
+  }
+};
+
+template <class Map, class Parse>
+auto parse_run(std::string const & text, Parse & parse)
+-> std::vector<std::pair<typename Map::key_type, typename Map::mapped_type>> {
+  std::vector<std::pair<typename Map::key_type, typename Map::mapped_type>> run;
+  std::string_view rest(text);
+  while (!rest.empty()) {
+    auto const eol = rest.find('\n');
+    auto line = rest.substr(0, eol);
+    rest.remove_prefix(eol == std::string_view::npos ? rest.size() : eol + 1);
+    if (!line.empty() && line.back() == '\r') { line.remove_suffix(1); }
+    if (auto record = parse(line)) { run.emplace_back(std::move(record->first), std::move(record->second)); }
+  }
+  auto const comp = Map().key_comp();
+  std::stable_sort(run.begin(), run.end(),
+                   [&comp](auto const & lhs, auto const & rhs) { return comp(lhs.first, rhs.first); });
+  return run;
+}
+
+template <class Map, class Parse>
+auto load_pipeline(thread_pool & pool, std::filesystem::path path, Parse parse,
+                   load_options opts, std::shared_ptr<load_counters> counters) -> task<Map> {
+  co_await pool.schedule();
+
+  auto in = std::make_shared<std::ifstream>(path, std::ios::binary);
+  if (!*in) { throw std::runtime_error(std::string("cmapio::load_map: cannot open ") + path.string()); }
+  counters->bytes_total = static_cast<std::size_t>(std::filesystem::file_size(path));
+
+  auto const chunk_bytes = std::max<std::size_t>(opts.chunk_bytes, 1);
+  auto read_chunk = [in, chunk_bytes, counters] {
+    std::string buffer(chunk_bytes, '\0');
+    in->read(buffer.data(), static_cast<std::streamsize>(chunk_bytes));
+    buffer.resize(static_cast<std::size_t>(in->gcount()));
+    counters->bytes_read += buffer.size();
+    return buffer;
+  };
+  using run_type = decltype(parse_run<Map>(std::string(), parse));
+
+  Map map;
+  std::deque<job<run_type>> parsing;
+  std::string carry;
+  auto pending_read = pool.submit(read_chunk);
+
+  for (auto eof = false; !eof; ) {
+    auto chunk = co_await pending_read;
+    eof = chunk.empty();
+    if (!eof) { pending_read = pool.submit(read_chunk); }
+
+    // whole lines go to a parser; a trailing partial line waits for the next chunk
+    carry += chunk;
+    auto const eol = carry.rfind('\n');
+    auto const cut = eof ? carry.size() : eol == std::string::npos ? 0 : eol + 1;
+    if (cut > 0) {
+      auto text = carry.substr(0, cut);
+      carry.erase(0, cut);
+      parsing.push_back(pool.submit([text = std::move(text), parse, counters]() mutable {
+        auto run = parse_run<Map>(text, parse);
+        counters->records_parsed += run.size();
+        return run;
+      }));
+    }
+
+    while (!parsing.empty() && (eof || parsing.size() > opts.parse_depth)) {
+      auto run = co_await parsing.front();
+      parsing.pop_front();
+      if (run.empty()) { continue; }
+      auto hint = map.lower_bound(run.front().first);
+      for (auto & [key, value] : run) {
+        hint = std::next(map.emplace_hint(hint, std::move(key), std::move(value)));
+      }
+      counters->records_inserted += run.size();
+      if (opts.on_progress) { opts.on_progress(counters->snapshot()); }
+    }
+  }
+  co_return map;
+}
+
+} /* namespace detail */
+
+/*
+ *  MARK: loading<Map>
+ *  A load in progress: progress() may be polled from any thread,
+ *  co_await yields the map, get() blocks for it.
+ */
+template <class Map>
+class loading {
+public:
+  loading(job<Map> result, std::shared_ptr<detail::load_counters> counters)
+    : result_(std::move(result)), counters_(std::move(counters)) {}
+
+  auto progress() const -> load_progress { return counters_->snapshot(); }
+
+  auto await_ready() const -> bool { return result_.await_ready(); }
+  auto await_suspend(std::coroutine_handle<> caller) -> bool { return result_.await_suspend(caller); }
+  auto await_resume() -> Map { return result_.await_resume(); }
+  auto get() -> Map { return result_.get(); }
+
+private:
+  job<Map>                               result_;
+  std::shared_ptr<detail::load_counters> counters_;
+};
+
+template <class Map, class Parse>
+auto load_map(thread_pool & pool, std::filesystem::path path, Parse parse,
+              load_options opts = {}) -> loading<Map> {
+  auto counters = std::make_shared<detail::load_counters>();
+  auto result = pool.spawn(detail::load_pipeline<Map>(pool, std::move(path), std::move(parse),
+                                                      std::move(opts), counters));
+  return loading<Map>(std::move(result), std::move(counters));
+}
+
+// the one-step-at-a-time reference: getline, parse, emplace
+template <class Map, class Parse>
+auto read_map(std::filesystem::path const & path, Parse parse) -> Map {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) { throw std::runtime_error(std::string("cmapio::read_map: cannot open ") + path.string()); }
+  Map map;
+  for (std::string line; std::getline(in, line); ) {
+    if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+    if (auto record = parse(std::string_view(line))) {
+      map.emplace(std::move(record->first), std::move(record->second));
+    }
+  }
+  return map;
+}
+
+} /* namespace cmapio */
+
+#endif /* map_loader_hpp */
@@ -0,0 +1,295 @@
+//
+//  map_parallel.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/container/map/erase_if
+//  @see: https://en.cppreference.com/w/cpp/container/map/extract
+//  @see: https://en.cppreference.com/w/cpp/container/map/merge
+//
+
+#ifndef map_parallel_hpp
+#define map_parallel_hpp
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <functional>
+#include <concepts>
+#include <cstddef>
+#include <cmath>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmappar
+namespace cmappar {
+
+inline
+auto default_threads() -> unsigned {
+  auto const hwc = std::thread::hardware_concurrency();
+  return hwc == 0 ? 1 : hwc;
+}
+
+/*
+ *  MARK: for_chunks()
+ *  Split [0, count) into at most parts contiguous chunks and call
+ *  fn(chunk, first, last) for each, one thread per chunk.  The calling
+ *  thread takes chunk 0.  The first exception thrown is rethrown here
+ *  once every chunk has finished.
+ */
+template <class Fn>
+auto for_chunks(std::size_t count, unsigned parts, Fn && fn) -> void {
+  if (count == 0) { return; }
+  auto const nparts = static_cast<std::size_t>(
+    std::clamp<std::size_t>(parts, 1, count));
+  auto bound = [count, nparts](std::size_t part) { return count * part / nparts; };
+
+  std::exception_ptr failure;
+  std::mutex failure_mx;
+  auto guarded = [&](std::size_t part) {
+    try {
+      fn(part, bound(part), bound(part + 1));
+    }
+    catch (...) {
+      auto lock = std::scoped_lock(failure_mx);
+      if (!failure) { failure = std::current_exception(); }
+    }
+  };
+
+  {
+    std::vector<std::jthread> workers;
+    workers.reserve(nparts - 1);
+    for (std::size_t part = 1; part < nparts; ++part) {
+      workers.emplace_back(guarded, part);
+    }
+    guarded(0);
+  } // join
+
+  if (failure) { std::rethrow_exception(failure); }
+}
+
+/*
+ *  MARK: node_container
+ *  Node-based associative containers: std::map, std::multimap,
+ *  std::set and std::multiset.
+ */
+template <class Co>
+concept node_container = requires(Co co, typename Co::iterator it) {
+  typename Co::node_type;
+  { co.extract(it) } -> std::same_as<typename Co::node_type>;
+  co.insert(co.end(), co.extract(it));
+  co.key_comp();
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: erase_if()
+ *  Bulk filtered erase.  The predicate is evaluated in parallel over
+ *  contiguous key ranges (so it must be safe to call concurrently on
+ *  distinct elements), then:
+ *    - when the erased fraction is at least rebuild_fraction, the
+ *      survivors are spliced into a fresh tree with end() hints (linear
+ *      time, no allocation) and the doomed nodes are freed wholesale;
+ *    - otherwise the doomed elements are erased in place.
+ *  Either way references to surviving elements stay valid and the
+ *  return value is the count std::erase_if would have returned.
+ */
+struct erase_options {
+  unsigned    threads          = default_threads();
+  double      rebuild_fraction = 0.5;
+  std::size_t min_parallel     = 1 << 14;  // below this, std::erase_if
+};
+
+template <node_container Co, class Pred>
+auto erase_if(Co & co, Pred pred, erase_options const & opts = {})
+-> typename Co::size_type {
+  auto const total = co.size();
+  if (total < opts.min_parallel || opts.threads <= 1) {
+    return std::erase_if(co, std::move(pred));
+  }
+
+  std::vector<typename Co::iterator> items;
+  items.reserve(total);
+  for (auto it = co.begin(); it != co.end(); ++it) { items.push_back(it); }
+
+  // one flag per element; chunk counts avoid a second pass
+  std::vector<unsigned char> doomed(total);
+  std::vector<std::size_t> chunk_counts(opts.threads, 0);
+  for_chunks(total, opts.threads,
+             [&](std::size_t chunk, std::size_t first, std::size_t last) {
+    std::size_t hits = 0;
+    for (auto ix = first; ix < last; ++ix) {
+      auto const drop = static_cast<bool>(std::invoke(pred, std::as_const(*items[ix])));
+      doomed[ix] = drop;
+      hits += drop;
+    }
+    chunk_counts[chunk] = hits;
+  });
+
+  auto const erased = std::accumulate(chunk_counts.cbegin(), chunk_counts.cend(),
+                                      std::size_t { 0 });
+  if (erased == 0) { return 0; }
+
+  if (static_cast<double>(erased) >= opts.rebuild_fraction * static_cast<double>(total)) {
+    Co survivors(co.key_comp(), co.get_allocator());
+    for (std::size_t ix = 0; ix < total; ++ix) {
+      if (!doomed[ix]) { survivors.insert(survivors.end(), co.extract(items[ix])); }
+    }
+    co.swap(survivors);
+    survivors.clear();  // doomed nodes: freed without rebalancing
+  }
+  else {
+    for (std::size_t ix = 0; ix < total; ++ix) {
+      if (doomed[ix]) { co.erase(items[ix]); }
+    }
+  }
+
+  return erased;
+}
+
+/*
+ *  MARK: unique_keys
+ *  std::map / std::set (insert(node_type&&) reports success) as opposed
+ *  to std::multimap / std::multiset.
+ */
+template <class Co>
+concept unique_keys = node_container<Co> && requires {
+  typename Co::insert_return_type;
+};
+
+template <class Co>
+auto key_of(typename Co::value_type const & value) -> typename Co::key_type const & {
+  if constexpr (requires { typename Co::mapped_type; }) {
+    return value.first;
+  }
+  else {
+    return value;
+  }
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: merge()
+ *  Same result as dst.merge(src): nodes move without reallocation and,
+ *  for unique-key containers, colliding elements stay behind in src.
+ *  Both trees are walked in key order and every node is inserted with a
+ *  hint at its final position, so the whole merge is O(n + m) instead of
+ *  O(m log(n + m)).  When src is tiny next to dst the log-time member
+ *  merge is cheaper, and is used instead.
+ *
+ *  With threads > 1 the key-range search (which src elements collide,
+ *  and where each one lands in dst) is split across threads; the splice
+ *  itself stays sequential because a tree cannot be mutated concurrently.
+ *  Returns the number of elements transferred.
+ */
+struct merge_options {
+  unsigned    threads      = 1;
+  std::size_t min_parallel = 1 << 14;
+};
+
+template <node_container Co>
+auto merge(Co & dst, Co & src, merge_options const & opts = {})
+-> typename Co::size_type {
+  auto const nsrc = src.size();
+  auto const ndst = dst.size();
+  if (&dst == &src || nsrc == 0) { return 0; }
+
+  auto const log_cost = static_cast<double>(nsrc)
+                      * std::log2(static_cast<double>(ndst) + 2.0);
+  if (log_cost < static_cast<double>(ndst + nsrc)) {
+    dst.merge(src);
+    return nsrc - src.size();
+  }
+
+  auto const comp = dst.key_comp();
+  // first dst position the key must be inserted before
+  auto lands_before = [&comp](typename Co::key_type const & key,
+                              typename Co::value_type const & there) {
+    if constexpr (unique_keys<Co>) {
+      return !comp(key_of<Co>(there), key);   // lower bound: stop on equal
+    }
+    else {
+      return comp(key, key_of<Co>(there));    // upper bound: after equals
+    }
+  };
+  auto collides = [&comp](typename Co::key_type const & key,
+                          typename Co::value_type const & there) {
+    return unique_keys<Co> && !comp(key, key_of<Co>(there));
+  };
+
+  typename Co::size_type moved = 0;
+
+  if (opts.threads <= 1 || nsrc < opts.min_parallel) {
+    auto pos = dst.begin();
+    for (auto sit = src.begin(); sit != src.end(); ) {
+      auto const & key = key_of<Co>(*sit);
+      while (pos != dst.end() && !lands_before(key, *pos)) { ++pos; }
+      if (pos != dst.end() && collides(key, *pos)) { ++sit; continue; }
+      auto next = std::next(sit);
+      dst.insert(pos, src.extract(sit));
+      sit = next;
+      ++moved;
+    }
+    return moved;
+  }
+
+  std::vector<typename Co::iterator> items;
+  items.reserve(nsrc);
+  for (auto it = src.begin(); it != src.end(); ++it) { items.push_back(it); }
+
+  // dst iterators are not invalidated by insertion, so the landing
+  //  positions found up front stay exact hints during the splice.
+  std::vector<typename Co::iterator> landing(nsrc);
+  std::vector<unsigned char> stays(nsrc);
+  for_chunks(nsrc, opts.threads,
+             [&](std::size_t, std::size_t first, std::size_t last) {
+    auto const & lead = key_of<Co>(*items[first]);
+    auto pos = unique_keys<Co> ? dst.lower_bound(lead) : dst.upper_bound(lead);
+    for (auto ix = first; ix < last; ++ix) {
+      auto const & key = key_of<Co>(*items[ix]);
+      while (pos != dst.end() && !lands_before(key, *pos)) { ++pos; }
+      landing[ix] = pos;
+      stays[ix] = pos != dst.end() && collides(key, *pos);
+    }
+  });
+
+  for (std::size_t ix = 0; ix < nsrc; ++ix) {
+    if (stays[ix]) { continue; }
+    dst.insert(landing[ix], src.extract(items[ix]));
+    ++moved;
+  }
+  return moved;
+}
+
+/*
+ *  MARK: set_union()
+ *  A new container holding every key of lhs and rhs (lhs wins ties, as
+ *  in merge), built in one ordered pass with end() hints: O(n + m).
+ */
+template <unique_keys Co>
+auto set_union(Co const & lhs, Co const & rhs) -> Co {
+  Co result(lhs.key_comp(), lhs.get_allocator());
+  auto const comp = lhs.key_comp();
+  auto lit = lhs.begin();
+  auto rit = rhs.begin();
+  while (lit != lhs.end() || rit != rhs.end()) {
+    if (rit == rhs.end()
+     || (lit != lhs.end() && !comp(key_of<Co>(*rit), key_of<Co>(*lit)))) {
+      if (rit != rhs.end() && !comp(key_of<Co>(*lit), key_of<Co>(*rit))) { ++rit; }
+      result.emplace_hint(result.end(), *lit++);
+    }
+    else {
+      result.emplace_hint(result.end(), *rit++);
+    }
+  }
+  return result;
+}
+
+} /* namespace cmappar */
+
+#endif /* map_parallel_hpp */
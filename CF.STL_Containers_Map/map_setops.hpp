@@ -0,0 +1,311 @@
+//
+//  map_setops.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/algorithm/set_intersection
+//  @see: https://en.cppreference.com/w/cpp/algorithm/set_difference
+//  @see: Bentley & Yao, "An almost optimal algorithm for unbounded searching"
+//
+
+#ifndef map_setops_hpp
+#define map_setops_hpp
+
+#include <map>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <ranges>
+#include <tuple>
+#include <cstddef>
+
+#include "map_parallel.hpp"
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapset
+namespace cmapset {
+
+// key of a map element (pair) or of a set element (itself)
+template <class Vt>
+auto key_ref(Vt const & value) -> decltype(auto) {
+  if constexpr (requires { value.first; }) { return (value.first); }
+  else                                     { return (value); }
+}
+
+template <class Rg>
+auto key_comp_of(Rg const & range) {
+  if constexpr (requires { range.key_comp(); }) { return range.key_comp(); }
+  else                                          { return std::less<> {}; }
+}
+
+/*
+ *  MARK: seek()
+ *  Advance it to the first element of range whose key is not less than
+ *  key.  Contiguous sorted ranges gallop (1, 2, 4, ... steps then a
+ *  binary search), costing O(log d) for a distance d.  Trees take a few
+ *  linear steps, which is all dense inputs need, then fall back to the
+ *  container's own O(log n) lower_bound for the sparse side.
+ */
+inline constexpr int finger_steps = 8;
+
+template <class Rg, class It, class Key, class Comp>
+auto seek(Rg const & range, It it, Key const & key, Comp comp) -> It {
+  auto const last = std::ranges::end(range);
+  auto below = [&key, &comp](auto const & value) { return comp(key_ref(value), key); };
+
+  if constexpr (std::random_access_iterator<It>) {
+    if (it == last || !below(*it)) { return it; }
+    auto lo = it;                         // invariant: *lo < key
+    for (std::ptrdiff_t step = 1; ; step *= 2) {
+      if (step >= last - lo) { return std::partition_point(lo + 1, last, below); }
+      auto const hi = lo + step;
+      if (!below(*hi)) { return std::partition_point(lo + 1, hi, below); }
+      lo = hi;
+    }
+  }
+  else {
+    for (int ix = 0; ix < finger_steps; ++ix) {
+      if (it == last || !below(*it)) { return it; }
+      ++it;
+    }
+    if constexpr (requires { range.lower_bound(key); }) {
+      return range.lower_bound(key);
+    }
+    else {
+      while (it != last && below(*it)) { ++it; }
+      return it;
+    }
+  }
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: set_view
+ *  Lazily evaluated set kernel over two ranges sorted by the same key
+ *  order (std::map, std::set, or a sorted vector of pairs):
+ *    - intersection: lhs elements whose key is in rhs
+ *    - difference:   lhs elements whose key is not in rhs
+ *    - join:         (lhs element, rhs element) pairs with equal keys
+ *  Intersection and join leapfrog: each side seeks to the other's key,
+ *  so skewed sizes cost O(m log n) rather than O(n + m).  Nothing is
+ *  copied; elements are yielded by reference.
+ */
+enum class kernel { intersection, difference, join, };
+
+template <kernel Mode, class Lhs, class Rhs>
+class set_view {
+public:
+  using lhs_iterator = std::ranges::iterator_t<Lhs const>;
+  using rhs_iterator = std::ranges::iterator_t<Rhs const>;
+  using lhs_value    = std::ranges::range_value_t<Lhs>;
+  using rhs_value    = std::ranges::range_value_t<Rhs>;
+
+  class iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type   = std::ptrdiff_t;
+    using value_type = std::conditional_t<Mode == kernel::join,
+      std::pair<lhs_value const &, rhs_value const &>, lhs_value>;
+    using reference  = std::conditional_t<Mode == kernel::join,
+      value_type, lhs_value const &>;
+
+    iterator() = default;
+    iterator(set_view const * view, lhs_iterator lit, rhs_iterator rit)
+      : view_(view), lit_(lit), rit_(rit) { settle(); }
+
+    auto operator*() const -> reference {
+      if constexpr (Mode == kernel::join) { return { *lit_, *rit_ }; }
+      else                                { return *lit_; }
+    }
+    auto operator++() -> iterator & {
+      ++lit_;
+      if constexpr (Mode == kernel::join) { ++rit_; }
+      settle();
+      return *this;
+    }
+    auto operator++(int) -> iterator { auto tmp = *this; ++*this; return tmp; }
+    friend auto operator==(iterator const & lhs, iterator const & rhs) -> bool {
+      return lhs.lit_ == rhs.lit_;
+    }
+
+    auto lhs_position() const -> lhs_iterator { return lit_; }
+    auto rhs_position() const -> rhs_iterator { return rit_; }
+
+  private:
+    auto settle() -> void {
+      auto const & comp = view_->comp_;
+      auto const rend = std::ranges::end(*view_->rhs_);
+      while (lit_ != view_->lend_) {
+        auto const & key = key_ref(*lit_);
+        rit_ = seek(*view_->rhs_, rit_, key, comp);
+        auto const hit = rit_ != rend && !comp(key, key_ref(*rit_));
+        if constexpr (Mode == kernel::difference) {
+          if (!hit) { return; }
+          ++lit_;
+        }
+        else {
+          if (hit) { return; }
+          if (rit_ == rend) { lit_ = view_->lend_; return; }
+          lit_ = seek(*view_->lhs_, lit_, key_ref(*rit_), comp);
+          if (view_->lend_ != std::ranges::end(*view_->lhs_)) {
+            // sub-range: don't let the seek run past the chunk
+            lit_ = clamp_to_chunk(lit_);
+          }
+        }
+      }
+    }
+
+    auto clamp_to_chunk(lhs_iterator it) const -> lhs_iterator {
+      auto const & comp = view_->comp_;
+      if (it == std::ranges::end(*view_->lhs_)
+       || !comp(key_ref(*it), key_ref(*view_->lend_))) {
+        return view_->lend_;
+      }
+      return it;
+    }
+
+    set_view const * view_ = nullptr;
+    lhs_iterator lit_ {};
+    rhs_iterator rit_ {};
+  };
+
+  set_view(Lhs const & lhs, Rhs const & rhs)
+    : set_view(lhs, rhs, std::ranges::begin(lhs), std::ranges::end(lhs)) {}
+
+  // the part of the kernel whose lhs keys lie in [first, last)
+  set_view(Lhs const & lhs, Rhs const & rhs, lhs_iterator first, lhs_iterator last)
+    : lhs_(&lhs), rhs_(&rhs), lbegin_(first), lend_(last), comp_(key_comp_of(lhs)) {}
+
+  auto begin() const -> iterator {
+    auto rit = std::ranges::begin(*rhs_);
+    if (lbegin_ != std::ranges::begin(*lhs_) && lbegin_ != lend_) {
+      rit = seek(*rhs_, rit, key_ref(*lbegin_), comp_);
+    }
+    return iterator(this, lbegin_, rit);
+  }
+  auto end() const -> iterator { return iterator(this, lend_, std::ranges::end(*rhs_)); }
+
+  auto lhs() const -> Lhs const & { return *lhs_; }
+  auto rhs() const -> Rhs const & { return *rhs_; }
+
+private:
+  Lhs const *  lhs_;
+  Rhs const *  rhs_;
+  lhs_iterator lbegin_;
+  lhs_iterator lend_;
+  decltype(key_comp_of(std::declval<Lhs const &>())) comp_;
+};
+
+template <class Lhs, class Rhs>
+auto intersection(Lhs const & lhs, Rhs const & rhs) {
+  return set_view<kernel::intersection, Lhs, Rhs>(lhs, rhs);
+}
+
+template <class Lhs, class Rhs>
+auto difference(Lhs const & lhs, Rhs const & rhs) {
+  return set_view<kernel::difference, Lhs, Rhs>(lhs, rhs);
+}
+
+template <class Lhs, class Rhs>
+auto join(Lhs const & lhs, Rhs const & rhs) {
+  return set_view<kernel::join, Lhs, Rhs>(lhs, rhs);
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: to_map()
+ *  Materialise a kernel.  Output arrives in key order, so every insert is
+ *  hinted at end() and the build is linear.  Intersection and difference
+ *  produce the lhs container type; join produces
+ *  std::map<key, std::pair<lhs mapped, rhs mapped>>.
+ *
+ *  With threads > 1 the lhs is cut into contiguous key ranges, each range
+ *  runs its own kernel (seeking into rhs independently), and the per-range
+ *  results are concatenated into the bulk build.
+ */
+namespace detail {
+
+template <kernel Mode, class Lhs, class Rhs>
+auto make_result(set_view<Mode, Lhs, Rhs> const & view) {
+  if constexpr (Mode == kernel::join) {
+    using key_type = std::remove_cvref_t<decltype(key_ref(*std::ranges::begin(view.lhs())))>;
+    using lhs_mapped = typename set_view<Mode, Lhs, Rhs>::lhs_value::second_type;
+    using rhs_mapped = typename set_view<Mode, Lhs, Rhs>::rhs_value::second_type;
+    return std::map<key_type, std::pair<lhs_mapped, rhs_mapped>,
+                    decltype(key_comp_of(view.lhs()))>(key_comp_of(view.lhs()));
+  }
+  else if constexpr (requires { view.lhs().key_comp(); }) {
+    return Lhs(view.lhs().key_comp(), view.lhs().get_allocator());
+  }
+  else {
+    return Lhs {};
+  }
+}
+
+template <bool Joined, class Out, class Lit, class Rit>
+auto append(Out & out, Lit lit, [[maybe_unused]] Rit rit) -> void {
+  if constexpr (Joined) {
+    out.emplace_hint(out.end(), std::piecewise_construct,
+                     std::forward_as_tuple(lit->first),
+                     std::forward_as_tuple(lit->second, rit->second));
+  }
+  else if constexpr (requires { out.emplace_hint(out.end(), *lit); }) {
+    out.emplace_hint(out.end(), *lit);
+  }
+  else {
+    out.push_back(*lit);
+  }
+}
+
+} /* namespace detail */
+
+template <kernel Mode, class Lhs, class Rhs>
+auto to_map(set_view<Mode, Lhs, Rhs> const & view) {
+  auto out = detail::make_result(view);
+  for (auto it = view.begin(); it != view.end(); ++it) {
+    detail::append<Mode == kernel::join>(out, it.lhs_position(), it.rhs_position());
+  }
+  return out;
+}
+
+template <kernel Mode, class Lhs, class Rhs>
+auto to_map(set_view<Mode, Lhs, Rhs> const & view, unsigned threads) {
+  using view_type = set_view<Mode, Lhs, Rhs>;
+  using hit = std::pair<typename view_type::lhs_iterator, typename view_type::rhs_iterator>;
+
+  if (threads <= 1) { return to_map(view); }
+
+  auto const & lhs = view.lhs();
+  std::vector<typename view_type::lhs_iterator> items;
+  items.reserve(std::ranges::size(lhs));
+  for (auto it = std::ranges::begin(lhs); it != std::ranges::end(lhs); ++it) {
+    items.push_back(it);
+  }
+  items.push_back(std::ranges::end(lhs));
+
+  auto const nitems = items.size() - 1;
+  auto const nparts = std::max<std::size_t>(1, std::min<std::size_t>(threads, nitems));
+  std::vector<std::vector<hit>> hits(nparts);
+  cmappar::for_chunks(nitems, static_cast<unsigned>(nparts),
+                      [&](std::size_t part, std::size_t first, std::size_t last) {
+    auto const sub = view_type(lhs, view.rhs(), items[first], items[last]);
+    for (auto it = sub.begin(); it != sub.end(); ++it) {
+      hits[part].emplace_back(it.lhs_position(), it.rhs_position());
+    }
+  });
+
+  auto out = detail::make_result(view);
+  for (auto const & part : hits) {
+    for (auto const & [lit, rit] : part) {
+      detail::append<Mode == kernel::join>(out, lit, rit);
+    }
+  }
+  return out;
+}
+
+} /* namespace cmapset */
+
+#endif /* map_setops_hpp */
@@ -0,0 +1,268 @@
+//
+//  map_traverse.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: Blumofe & Leiserson, "Scheduling Multithreaded Computations by Work Stealing"
+//  @see: https://en.cppreference.com/w/cpp/algorithm/for_each
+//  @see: https://en.cppreference.com/w/cpp/algorithm/reduce
+//
+
+#ifndef map_traverse_hpp
+#define map_traverse_hpp
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stop_token>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <iterator>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+#include "map_parallel.hpp"
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapws
+namespace cmapws {
+
+/*
+ *  MARK: work_stealing_pool
+ *  threads - 1 background workers plus whichever thread waits on a
+ *  task_group, which helps instead of blocking.  Each worker owns a
+ *  deque: it pushes and pops its own work at the back (newest first,
+ *  cache-warm) and steals from the front of the others (oldest, hence
+ *  largest, pieces of a recursive split).  Threads outside the pool
+ *  spawn into a shared injection queue.
+ */
+class work_stealing_pool {
+public:
+  using task = std::function<void()>;
+
+  //  MARK: task_group
+  class task_group {
+    friend class work_stealing_pool;
+
+  public:
+    task_group() = default;
+    task_group(task_group const &) = delete;
+    auto operator=(task_group const &) -> task_group & = delete;
+
+  private:
+    std::atomic<std::size_t> pending_ { 0 };
+    std::mutex               failure_mx_;
+    std::exception_ptr       failure_;
+  };
+
+  explicit work_stealing_pool(unsigned threads = cmappar::default_threads()) {
+    auto const nworkers = std::max(threads, 1u) - 1;
+    for (unsigned ix = 0; ix <= nworkers; ++ix) {     // [nworkers]: injection queue
+      queues_.push_back(std::make_unique<work_queue>());
+    }
+    workers_.reserve(nworkers);
+    for (unsigned ix = 0; ix < nworkers; ++ix) {
+      workers_.emplace_back([this, ix](std::stop_token stop) { work(ix, stop); });
+    }
+  }
+
+  work_stealing_pool(work_stealing_pool const &) = delete;
+  auto operator=(work_stealing_pool const &) -> work_stealing_pool & = delete;
+  ~work_stealing_pool() = default;
+
+  static auto shared() -> work_stealing_pool & {
+    static work_stealing_pool pool;
+    return pool;
+  }
+
+  // threads that run tasks, counting the waiting caller
+  auto size() const noexcept -> std::size_t { return workers_.size() + 1; }
+
+  template <class Fn>
+  auto spawn(task_group & group, Fn && fn) -> void {
+    group.pending_.fetch_add(1, std::memory_order_relaxed);
+    push([&group, fn = std::forward<Fn>(fn)]() mutable {
+      try { fn(); }
+      catch (...) {
+        auto lock = std::scoped_lock(group.failure_mx_);
+        if (!group.failure_) { group.failure_ = std::current_exception(); }
+      }
+      group.pending_.fetch_sub(1, std::memory_order_acq_rel);
+    });
+  }
+
+  // run queued tasks until the group is done; rethrow its first failure
+  auto wait(task_group & group) -> void {
+    auto const self = local_index();
+    while (group.pending_.load(std::memory_order_acquire) != 0) {
+      if (auto next = take(self)) { (*next)(); }
+      else                        { std::this_thread::yield(); }
+    }
+    if (group.failure_) { std::rethrow_exception(std::exchange(group.failure_, nullptr)); }
+  }
+
+private:
+  struct work_queue {
+    std::mutex       mx;
+    std::deque<task> tasks;
+  };
+
+  // this thread's own queue, or the injection queue outside the pool
+  auto local_index() const -> std::size_t {
+    return current_pool_ == this ? current_index_ : workers_.size();
+  }
+
+  auto push(task fn) -> void {
+    auto & queue = *queues_[local_index()];
+    {
+      auto lock = std::scoped_lock(queue.mx);
+      queue.tasks.push_back(std::move(fn));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    { auto lock = std::scoped_lock(sleep_mx_); }  // no wakeup lost to a sleeper
+    sleep_cv_.notify_one();
+  }
+
+  auto take(std::size_t self) -> std::optional<task> {
+    if (queued_.load(std::memory_order_acquire) == 0) { return std::nullopt; }
+    auto const nqueues = queues_.size();
+    for (std::size_t step = 0; step < nqueues; ++step) {
+      auto const ix = (self + step) % nqueues;
+      auto & queue = *queues_[ix];
+      auto lock = std::scoped_lock(queue.mx);
+      if (queue.tasks.empty()) { continue; }
+      auto const own = ix == self && self < workers_.size();
+      auto fn = std::move(own ? queue.tasks.back() : queue.tasks.front());
+      if (own) { queue.tasks.pop_back(); } else { queue.tasks.pop_front(); }
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      return fn;
+    }
+    return std::nullopt;
+  }
+
+  auto work(std::size_t index, std::stop_token stop) -> void {
+    current_pool_ = this;
+    current_index_ = index;
+    while (!stop.stop_requested()) {
+      if (auto next = take(index)) { (*next)(); continue; }
+      auto lock = std::unique_lock(sleep_mx_);
+      sleep_cv_.wait(lock, stop, [this] { return queued_.load() != 0; });
+    }
+  }
+
+  inline static thread_local work_stealing_pool const * current_pool_ = nullptr;
+  inline static thread_local std::size_t current_index_ = 0;
+
+  std::vector<std::unique_ptr<work_queue>> queues_;
+  std::atomic<std::size_t>                 queued_ { 0 };
+  std::mutex                               sleep_mx_;
+  std::condition_variable_any              sleep_cv_;
+  std::vector<std::jthread>                workers_;  // last: joined first
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: parallel traversal
+ *  The container is cut into leaves of about grain elements, found with
+ *  nth() on an order-statistic tree (O(log n) each) or by one pointer
+ *  walk otherwise.  Leaves are handed out by recursive halving, so idle
+ *  workers steal large spans first.  The functor sees each element
+ *  exactly once; mapped values may be updated in place.
+ */
+struct traverse_options {
+  std::size_t          grain = 2'048;
+  work_stealing_pool * pool  = nullptr;   // nullptr: work_stealing_pool::shared()
+};
+
+namespace detail {
+
+template <class Co>
+auto leaf_bounds(Co & co, std::size_t grain) {
+  using iterator = decltype(co.begin());
+  auto const total = static_cast<std::size_t>(co.size());
+  grain = std::max<std::size_t>(grain, 1);
+  std::vector<iterator> bounds;
+  bounds.reserve(total / grain + 2);
+  if constexpr (requires { co.nth(std::size_t {}); }) {
+    for (std::size_t ix = 0; ix < total; ix += grain) { bounds.push_back(co.nth(ix)); }
+  }
+  else {
+    auto it = co.begin();
+    for (std::size_t ix = 0; ix < total; ++ix, ++it) {
+      if (ix % grain == 0) { bounds.push_back(it); }
+    }
+  }
+  bounds.push_back(co.end());
+  return bounds;
+}
+
+// call leaf(ix) for every ix in [lo, hi), spreading halves over the pool
+template <class Leaf>
+auto split(work_stealing_pool & pool, work_stealing_pool::task_group & group,
+           std::size_t lo, std::size_t hi, Leaf const & leaf) -> void {
+  while (hi - lo > 1) {
+    auto const mid = lo + (hi - lo) / 2;
+    pool.spawn(group, [&pool, &group, mid, hi, &leaf] { split(pool, group, mid, hi, leaf); });
+    hi = mid;
+  }
+  leaf(lo);
+}
+
+} /* namespace detail */
+
+template <class Co, class Fn>
+auto parallel_for_each(Co & co, Fn fn, traverse_options const & opts = {}) -> void {
+  auto & pool = opts.pool ? *opts.pool : work_stealing_pool::shared();
+  auto const bounds = detail::leaf_bounds(co, opts.grain);
+  auto const nleaves = bounds.size() - 1;
+  if (nleaves == 0) { return; }
+
+  auto leaf = [&bounds, &fn](std::size_t ix) {
+    for (auto it = bounds[ix]; it != bounds[ix + 1]; ++it) { std::invoke(fn, *it); }
+  };
+  work_stealing_pool::task_group group;
+  pool.spawn(group, [&] { detail::split(pool, group, 0, nleaves, leaf); });
+  pool.wait(group);
+}
+
+/*
+ *  MARK: parallel_reduce()
+ *  combine(..., map(element)) over the container in key order.  combine
+ *  must be associative and init its identity; it need not commute, as
+ *  the per-leaf partials are folded left to right.
+ */
+template <class Co, class R, class MapFn, class Combine>
+auto parallel_reduce(Co const & co, R init, MapFn map, Combine combine,
+                     traverse_options const & opts = {}) -> R {
+  auto & pool = opts.pool ? *opts.pool : work_stealing_pool::shared();
+  auto const bounds = detail::leaf_bounds(co, opts.grain);
+  auto const nleaves = bounds.size() - 1;
+
+  std::vector<R> partials(nleaves, init);
+  auto leaf = [&](std::size_t ix) {
+    auto acc = init;
+    for (auto it = bounds[ix]; it != bounds[ix + 1]; ++it) {
+      acc = std::invoke(combine, std::move(acc), std::invoke(map, *it));
+    }
+    partials[ix] = std::move(acc);
+  };
+  if (nleaves > 0) {
+    work_stealing_pool::task_group group;
+    pool.spawn(group, [&] { detail::split(pool, group, 0, nleaves, leaf); });
+    pool.wait(group);
+  }
+
+  for (auto & part : partials) { init = std::invoke(combine, std::move(init), std::move(part)); }
+  return init;
+}
+
+} /* namespace cmapws */
+
+#endif /* map_traverse_hpp */
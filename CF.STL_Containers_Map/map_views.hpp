@@ -0,0 +1,162 @@
+//
+//  map_views.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/ranges/keys_view
+//  @see: https://en.cppreference.com/w/cpp/ranges/filter_view
+//  @see: https://en.cppreference.com/w/cpp/container/map/emplace_hint
+//
+
+#ifndef map_views_hpp
+#define map_views_hpp
+
+#include <map>
+#include <ranges>
+#include <iterator>
+#include <utility>
+#include <tuple>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapview
+namespace cmapview {
+
+/*
+ *  MARK: views
+ *  Lazy, non-owning views over a map (or over another view).  Iterating
+ *  yields references into the map, so neither pairs nor keys are copied
+ *  and nothing is allocated; mapped values seen through a non-const map
+ *  may be assigned in place.  Views hold iterators or a pointer to the
+ *  map: the map must outlive them, and erasing an element invalidates
+ *  any view positioned on it.
+ *    keys(m)            - key const & in key order
+ *    values(m)          - mapped & in key order
+ *    range(m, lo, hi)   - elements with keys in [lo, hi), via lower_bound
+ *    filter(rg, pred)   - elements for which pred holds
+ *    zip(a, b)          - (a element, b element) pairs in lockstep, until
+ *                         the shorter side ends; cmapset::join matches keys
+ *  All of them compose: keys(filter(range(m, 10, 20), pred)).
+ */
+template <std::ranges::viewable_range Rg>
+auto keys(Rg && rg) {
+  return std::views::keys(std::forward<Rg>(rg));
+}
+
+template <std::ranges::viewable_range Rg>
+auto values(Rg && rg) {
+  return std::views::values(std::forward<Rg>(rg));
+}
+
+// the elements of map with keys in [lo, hi); both ends found in O(log n)
+template <class Map, class Lo, class Hi>
+auto range(Map & map, Lo const & lo, Hi const & hi) {
+  auto first = map.lower_bound(lo);
+  auto last  = map.lower_bound(hi);
+  if (map.key_comp()(hi, lo)) { last = first; }   // empty, not undefined
+  return std::ranges::subrange(first, last);
+}
+
+template <std::ranges::viewable_range Rg, class Pred>
+auto filter(Rg && rg, Pred pred) {
+  return std::views::filter(std::forward<Rg>(rg), std::move(pred));
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: zip_view
+ *  Two ranges walked in lockstep; each step yields a pair of references.
+ *  End is reached as soon as either side ends.
+ */
+template <std::ranges::view Lhs, std::ranges::view Rhs>
+class zip_view : public std::ranges::view_interface<zip_view<Lhs, Rhs>> {
+public:
+  using lhs_iterator = std::ranges::iterator_t<Lhs>;
+  using rhs_iterator = std::ranges::iterator_t<Rhs>;
+  using lhs_sentinel = std::ranges::sentinel_t<Lhs>;
+  using rhs_sentinel = std::ranges::sentinel_t<Rhs>;
+
+  class iterator {
+  public:
+    using iterator_concept = std::forward_iterator_tag;
+    using difference_type  = std::ptrdiff_t;
+    using value_type = std::pair<std::ranges::range_value_t<Lhs>, std::ranges::range_value_t<Rhs>>;
+    using reference  = std::pair<std::ranges::range_reference_t<Lhs>,
+                                 std::ranges::range_reference_t<Rhs>>;
+
+    iterator() = default;
+    iterator(lhs_iterator lit, lhs_sentinel lend, rhs_iterator rit, rhs_sentinel rend)
+      : lit_(lit), lend_(lend), rit_(rit), rend_(rend) {}
+
+    auto operator*() const -> reference { return reference(*lit_, *rit_); }
+    auto operator++() -> iterator & { ++lit_; ++rit_; return *this; }
+    auto operator++(int) -> iterator { auto tmp = *this; ++*this; return tmp; }
+
+    friend auto operator==(iterator const & lhs, iterator const & rhs) -> bool {
+      return lhs.lit_ == rhs.lit_ && lhs.rit_ == rhs.rit_;
+    }
+    friend auto operator==(iterator const & it, std::default_sentinel_t) -> bool {
+      return it.lit_ == it.lend_ || it.rit_ == it.rend_;
+    }
+
+  private:
+    lhs_iterator lit_ {};
+    lhs_sentinel lend_ {};
+    rhs_iterator rit_ {};
+    rhs_sentinel rend_ {};
+  };
+
+  zip_view() = default;
+  zip_view(Lhs lhs, Rhs rhs) : lhs_(std::move(lhs)), rhs_(std::move(rhs)) {}
+
+  auto begin() -> iterator {
+    return iterator(std::ranges::begin(lhs_), std::ranges::end(lhs_),
+                    std::ranges::begin(rhs_), std::ranges::end(rhs_));
+  }
+  auto end() const noexcept -> std::default_sentinel_t { return std::default_sentinel; }
+
+private:
+  Lhs lhs_;
+  Rhs rhs_;
+};
+
+template <std::ranges::viewable_range Lhs, std::ranges::viewable_range Rhs>
+auto zip(Lhs && lhs, Rhs && rhs) {
+  return zip_view<std::views::all_t<Lhs>, std::views::all_t<Rhs>>(
+    std::views::all(std::forward<Lhs>(lhs)), std::views::all(std::forward<Rhs>(rhs)));
+}
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: to_map()
+ *  Materialise any view of (key, mapped) pairs.  Every element is
+ *  emplaced with end() as the hint: views of a map arrive in key order,
+ *  so each insert lands where the hint says and the whole build is
+ *  linear, not O(n log n).  Out-of-order input is still correct, it just
+ *  pays the ordinary O(log n) per element.  Without an explicit Map the
+ *  result is std::map<key, mapped> with the pair's decayed types.
+ */
+template <class Map, std::ranges::input_range Rg>
+auto to_map(Rg && rg) -> Map {
+  Map out;
+  for (auto && element : rg) {
+    auto && [key, mapped] = element;
+    out.emplace_hint(out.end(), key, mapped);
+  }
+  return out;
+}
+
+template <std::ranges::input_range Rg>
+auto to_map(Rg && rg) {
+  using element = std::ranges::range_reference_t<Rg>;
+  using key_type    = std::remove_cvref_t<std::tuple_element_t<0, std::remove_cvref_t<element>>>;
+  using mapped_type = std::remove_cvref_t<std::tuple_element_t<1, std::remove_cvref_t<element>>>;
+  return to_map<std::map<key_type, mapped_type>>(std::forward<Rg>(rg));
+}
+
+} /* namespace cmapview */
+
+#endif /* map_views_hpp */
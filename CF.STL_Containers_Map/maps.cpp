@@ -21,10 +21,37 @@
 #include <span>
 #include <map>
 #include <vector>
+#include <chrono>
+#include <functional>
+#include <optional>
+#include <fstream>
+#include <filesystem>
+#include <charconv>
 #include <cassert>
+#include <cctype>
 #include <cstddef>
 #include <cmath>
 
+#include "art_map.hpp"
+#include "map_parallel.hpp"
+#include "map_setops.hpp"
+#include "fingerprint_map.hpp"
+#include "order_statistic_map.hpp"
+#include "timeseries_map.hpp"
+#include "persistent_map.hpp"
+#include "rcu_map.hpp"
+#include "recycling_map.hpp"
+#include "map_loader.hpp"
+#include "map_traverse.hpp"
+#include "map_views.hpp"
+#include "small_map.hpp"
+#include "bucket_multimap.hpp"
+#include "map_instrument.hpp"
+#include "map_hints.hpp"
+#include "fast_less.hpp"
+#include "numa_map.hpp"
+#include "cache_map.hpp"
+
 using namespace std::literals::string_literals;
 
 //  MARK: - Definitions
@@ -52,6 +79,7 @@ auto const dot = delimiter('.');
 
 //  MARK: - Function Prototype.
 auto C_map(int argc, const char * argv[]) -> decltype(argc);
+auto C_map_ext(int argc, const char * argv[]) -> decltype(argc);
 
 //  MARK: - Implementation.
 //  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
@@ -65,6 +93,9 @@ int main(int argc, const char * argv[]) {
   std::cout << '\n' << konst::dlm << std::endl;
   C_map(argc, argv);
 
+  std::cout << '\n' << konst::dlm << std::endl;
+  C_map_ext(argc, argv);
+
   return 0;
 }
 
@@ -232,7 +263,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
       { { -8, -15 }, 17 }
     };
 
-    for (auto pt : mag) {
+    for (auto const & pt : mag) {
         std::cout << "The magnitude of ("s << pt.first.x_val
                   << ", "s << pt.first.y_val << ") is "s
                   << pt.second << '\n';
@@ -306,7 +337,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
   {
 
     auto keys = std::vector { "π"s, "e"s };
-    auto mmap = std::map<std::string, double> {
+    auto mmap = cmapinst::traced_map<std::string, double> {
       { keys[0], M_PI, }, { keys[1], M_E, },
     };
 
@@ -326,7 +357,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
   std::cout << konst::dot << '\n';
   std::cout << "std::map - operator[]"s << '\n';
   {
-    std::map<char, int> letter_counts { { 'a', 27 }, { 'b', 3 }, { 'c', 1 }, };
+    cmapinst::traced_map<char, int> letter_counts { { 'a', 27 }, { 'b', 3 }, { 'c', 1 }, };
 
     std::cout << "initially:\n"s;
     for (const auto &kvpair : letter_counts) {
@@ -344,7 +375,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
 
     // count the number of occurrences of each word
     // (the first call to operator[] initialized the counter with zero)
-    std::map<std::string, size_t>  word_map;
+    cmapinst::traced_map<std::string, size_t>  word_map;
     for (const auto & word : {
       "this"s, "sentence"s, "is"s, "not"s, "a"s, "sentence"s,
       "this"s, "sentence"s, "is"s, "a"s, "hoax"s
@@ -418,16 +449,17 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
       }
 
       //Repeat the above with the range-based for loop
-      for (auto kvpair : mag) {
+      for (auto const & kvpair : mag) {
         auto cur = kvpair.first;
         cur->y_val = kvpair.second;
         mag[cur] = std::hypot(cur->x_val, cur->y_val);
         std::cout << "The magnitude of ("s << cur->x_val
                   << ", "s << cur->y_val << ") is ";
         std::cout << mag[cur] << '\n';
-        // Note that in contrast to std::cout << iter->second << '\n'; above,
-        // std::cout << i.second << '\n'; will NOT print the updated magnitude
-        // If auto &i: mag was used instead, it will print the updated magnitude
+        // Bound by reference, so no pair is copied per iteration and
+        // std::cout << kvpair.second << '\n'; prints the updated magnitude,
+        // as iter->second does above.  A plain auto kvpair would copy the
+        // pair and print the stale value.
       }
     }
 
@@ -695,7 +727,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
     const int nof_operations = 100'500;
 
     auto map_emplace = []() {
-      std::map<int, char> map;
+      cmapinst::traced_map<int, char> map;
       for(int i_ = 0; i_ < nof_operations; ++i_) {
         map.emplace(i_, 'a');
       }
@@ -703,40 +735,40 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
     };
 
     auto map_emplace_hint = []() {
-      std::map<int, char> map;
+      cmapinst::traced_map<int, char> map;
       auto it = map.begin();
       for(int i_ = 0; i_ < nof_operations; ++i_) {
-        map.emplace_hint(it, i_, 'b');
+        cmaphint::emplace_hint(map, it, i_, 'b');
         it = map.end();
       }
       return map.size();
     };
 
     auto map_emplace_hint_wrong = []() {
-      std::map<int, char> map;
+      cmapinst::traced_map<int, char> map;
       auto it = map.begin();
       for(int i_ = nof_operations; i_ > 0; --i_) {
-      map.emplace_hint(it, i_, 'c');
+      cmaphint::emplace_hint(map, it, i_, 'c');
         it = map.end();
       }
       return map.size();
     };
 
     auto map_emplace_hint_corrected = []() {
-      std::map<int, char> map;
+      cmapinst::traced_map<int, char> map;
       auto it = map.begin();
       for(int i_ = nof_operations; i_ > 0; --i_) {
-        map.emplace_hint(it, i_, 'd');
+        cmaphint::emplace_hint(map, it, i_, 'd');
         it = map.begin();
       }
       return map.size();
     };
 
     auto map_emplace_hint_closest = []() {
-      std::map<int, char> map;
+      cmapinst::traced_map<int, char> map;
       auto it = map.begin();
       for(int i_ = 0; i_ < nof_operations; ++i_) {
-        it = map.emplace_hint(it, i_, 'e');
+        it = cmaphint::emplace_hint(map, it, i_, 'e');
       }
       return map.size();
     };
@@ -784,7 +816,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
   std::cout << konst::dot << '\n';
   std::cout << "std::map - erase"s << '\n';
   {
-    std::map<int, std::string> container = {
+    cmapinst::traced_map<int, std::string> container = {
       { 1, "one"s  }, { 2, "two"s  }, { 3, "three"s },
       { 4, "four"s }, { 5, "five"s }, { 6, "six"s   },
     };
@@ -922,7 +954,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
     using namespace cmapfd;
 
     // simple comparison demo
-    std::map<int, char> example = {
+    cmapinst::traced_map<int, char> example = {
       { 1, 'a' },
       { 2, 'b' },
     };
@@ -1055,7 +1087,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
 
       auto constexpr val = 100;
 
-      for (auto it : cont) {
+      for (auto const & it : cont) {
         bool before = comp_func(it.first, val);
         bool after  = comp_func(val, it.first);
 
@@ -1081,7 +1113,7 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
 
       std::pair<int, char> constexpr val = { 100, 'a' };
 
-      for (auto it : cont) {
+      for (auto const & it : cont) {
         bool before = comp_func(it, val);
         bool after = comp_func(val, it);
 
@@ -1210,6 +1242,830 @@ auto C_map(int argc, const char * argv[]) -> decltype(argc) {
   }
 #endif  /* (__cplusplus > 201707L) */
 
+  // built with -DCMAP_INSTRUMENT=1 the traced_map sections above report here
+  if constexpr (cmapinst::enabled) {
+    std::cout << konst::dot << '\n';
+    std::cout << "cmapinst - C_map() sections, by key type"s << '\n';
+    std::cout << "std::string keys:\n"s << cmapinst::map_stats<std::string>::global()->take_snapshot()
+              << "char keys:\n"s << cmapinst::map_stats<char>::global()->take_snapshot()
+              << "int keys:\n"s << cmapinst::map_stats<int>::global()->take_snapshot() << '\n';
+  }
+
+  // and with -DCMAP_HINT_PROFILE=1 the emplace_hint section's call sites
+  if constexpr (cmaphint::enabled) {
+    std::cout << konst::dot << '\n';
+    std::cout << "cmaphint - C_map() hint accuracy by call site"s << '\n';
+    std::cout << cmaphint::hint_registry::instance() << '\n';
+  }
+
+  std::cout << std::endl; //  make sure cout is flushed.
+
+  return 0;
+}
+
+//  MARK: - C_map_ext
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: C_map_ext()
+ *  Ordered-map containers and algorithms that extend the std::map tour.
+ */
+auto C_map_ext(int argc, [[maybe_unused]] const char * argv[]) -> decltype(argc) {
+  std::cout << "In "s << __func__ << std::endl;
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapart::art_map - adaptive radix tree"s << '\n';
+  {
+    using namespace cmap;
+
+    // same keys as the swap demo: UTF-8 iterates in byte order
+    cmapart::art_map<std::string, std::string> greek {
+      { "γ"s, "gamma"s }, { "β"s, "beta"s  }, { "α"s, "alpha"s },
+      { "ε"s, "epsilon"s }, { "δ"s, "delta"s },
+    };
+    std::map<std::string, std::string> const sgreek(greek.begin(), greek.end());
+
+    std::cout << "art_map:  "s << greek;
+    std::cout << "std::map: "s << sgreek;
+    std::cout << std::boolalpha
+              << "same order: "s
+              << std::equal(greek.begin(), greek.end(), sgreek.begin(), sgreek.end())
+              << std::noboolalpha << '\n';
+
+    cmapart::art_map<std::string, int> words;
+    for (auto const & word : {
+      "this"s, "sentence"s, "is"s, "not"s, "a"s, "sentence"s,
+      "this"s, "sentence"s, "is"s, "a"s, "hoax"s, "thistle"s, "there"s,
+    }) {
+      ++words[word];
+    }
+
+    // prefix scan: equal_range over every key starting with "th"
+    auto const [first, last] = words.prefix_range("th"s);
+    std::cout << "prefix \"th\":"s;
+    for (auto it = first; it != last; ++it) {
+      std::cout << ' ' << it->first << '(' << it->second << ')';
+    }
+    std::cout << '\n';
+
+    // signed integer keys are stored big-endian with the sign bit flipped
+    cmapart::art_map<int, char> nums { { 5, 'e' }, { -3, 'c' }, { 0, 'z' }, { 42, 'x' }, };
+    std::cout << "int keys: "s << nums;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmappar::erase_if - parallel filtered erase"s << '\n';
+  {
+    auto const nof_elements = 400'000;
+
+    std::map<int, char> data;
+    for (int i_ = 0; i_ < nof_elements; ++i_) {
+      data.emplace_hint(data.end(), i_, 'a' + i_ % 26);
+    }
+    auto sdata = data;
+
+    auto odd = [](auto const & item) {
+      auto const & [key, value] = item;
+      return (key & 1) == 1;
+    };
+
+    auto timeit = [](auto && erase, std::string const & what) {
+      auto start = std::chrono::steady_clock::now();
+      auto const count = erase();
+      auto stop = std::chrono::steady_clock::now();
+      std::chrono::duration<double, std::milli> time = stop - start;
+      std::cout << std::fixed << std::setprecision(2) << std::setw(8)
+                << time.count() << "  ms for "s << what
+                << " ("s << count << " items removed)\n"s;
+      return count;
+    };
+
+    auto const scount = timeit([&] { return std::erase_if(sdata, odd); },
+                               "std::erase_if"s);
+    auto const pcount = timeit([&] { return cmappar::erase_if(data, odd); },
+                               "cmappar::erase_if"s);
+
+    std::cout << std::boolalpha
+              << "same count: "s << (scount == pcount)
+              << ", same contents: "s << (sdata == data) << '\n'
+              << std::noboolalpha;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmappar::merge - linear-time merge"s << '\n';
+  {
+    std::map<int, std::string> ma {
+      { 1, "apple"s }, { 5, "pear"s }, { 10, "banana"s },
+    };
+
+    std::map<int, std::string> mb {
+      { 2, "zorro"s }, { 4, "batman"s }, { 5, "X"s }, { 8, "alpaca"s },
+    };
+
+    std::map<int, std::string> mu;
+    cmappar::merge(mu, ma);
+    std::cout << "ma.size(): "s << ma.size() << '\n';
+    cmappar::merge(mu, mb);
+    std::cout << "mb.size(): "s << mb.size() << '\n';
+    std::cout << "mb.at(5):  "s << mb.at(5) << '\n';
+
+    for (auto const & kv: mu) {
+      std::cout << kv.first << ", " << kv.second << '\n';
+    }
+
+    // a delta map folded into a base map of the same magnitude
+    auto const nof_elements = 200'000;
+    std::map<int, int> base;
+    std::map<int, int> delta;
+    for (int i_ = 0; i_ < nof_elements; ++i_) {
+      base.emplace_hint(base.end(), i_ * 2, i_);
+      delta.emplace_hint(delta.end(), i_ * 3, -i_);
+    }
+    auto sbase = base;
+    auto sdelta = delta;
+
+    auto timeit = [](auto && merge, std::string const & what) {
+      auto start = std::chrono::steady_clock::now();
+      merge();
+      auto stop = std::chrono::steady_clock::now();
+      std::chrono::duration<double, std::milli> time = stop - start;
+      std::cout << std::fixed << std::setprecision(2) << std::setw(8)
+                << time.count() << "  ms for "s << what << '\n';
+    };
+
+    timeit([&] { sbase.merge(sdelta); }, "std::map::merge"s);
+    timeit([&] { cmappar::merge(base, delta); }, "cmappar::merge"s);
+
+    std::cout << std::boolalpha
+              << "same result: "s << (sbase == base && sdelta == delta) << '\n'
+              << std::noboolalpha;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapset - intersection, difference, join"s << '\n';
+  {
+    using namespace cmap;
+
+    std::map<int, char> alice { { 1, 'a' }, { 2, 'b' }, { 3, 'c' }, };
+    std::map<int, char> bob   { { 2, 'Y' }, { 3, 'X' }, { 10, 'W' }, };
+    std::map<int, std::string> eve { { 1, "one"s }, { 3, "three"s }, { 7, "seven"s }, };
+
+    // lazily evaluated: nothing is copied until to_map()
+    std::cout << "alice & bob:"s;
+    for (auto const & [key, value] : cmapset::intersection(alice, bob)) {
+      std::cout << ' ' << key << '(' << value << ')';
+    }
+    std::cout << '\n';
+
+    std::cout << "alice - bob: "s << cmapset::to_map(cmapset::difference(alice, bob));
+
+    std::cout << "alice join eve:"s;
+    for (auto const & [lhs, rhs] : cmapset::join(alice, eve)) {
+      std::cout << ' ' << lhs.first << '(' << lhs.second << ", "s << rhs.second << ')';
+    }
+    std::cout << '\n';
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapfp::fingerprinted_map - O(1) inequality"s << '\n';
+  {
+    using fmap = cmapfp::fingerprinted_map<int, char>;
+    fmap alice { { 1, 'a' }, { 2, 'b' }, { 3, 'c' }, };
+    fmap bob   { { 7, 'Z' }, { 8, 'Y' }, { 9, 'X' }, { 10, 'W' }, };
+    fmap eve   { { 3, 'c' }, { 1, 'a' }, { 2, 'b' }, };  // insertion order differs
+
+    std::cout << std::hex
+              << "alice: "s << alice.fingerprint() << '\n'
+              << "bob:   "s << bob.fingerprint() << '\n'
+              << "eve:   "s << eve.fingerprint() << '\n'
+              << std::dec;
+
+    std::cout << std::boolalpha;
+    std::cout << "alice == bob returns " << (alice == bob) << '\n';
+    std::cout << "alice == eve returns " << (alice == eve) << '\n';
+    std::cout << "alice <  bob returns " << (alice < bob) << '\n';
+
+    eve.update(2, [](char & ch) { ch = 'B'; });
+    std::cout << "after eve[2] = 'B', alice == eve returns " << (alice == eve) << '\n';
+    eve.insert_or_assign(2, 'b');
+    std::cout << "after eve[2] = 'b', alice == eve returns " << (alice == eve) << '\n';
+    std::cout << std::noboolalpha;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapos::order_statistic_map - nth, rank, count_range"s << '\n';
+  {
+    // leaderboard: score -> player
+    cmapos::order_statistic_map<int, std::string> scores {
+      { 1'200, "ana"s }, {   870, "bo"s  }, { 1'530, "cy"s  }, {   990, "dee"s },
+      { 1'410, "eli"s }, {   640, "fay"s }, { 1'105, "gus"s }, { 1'320, "hal"s },
+    };
+
+    auto const median = scores.nth(scores.size() / 2);
+    std::cout << "median: "s << median->second << " ("s << median->first << ")\n"s;
+    std::cout << "players below 1000: "s << scores.rank(1'000) << '\n';
+    std::cout << "players in [1000, 1400): "s << scores.count_range(1'000, 1'400) << '\n';
+
+    // node handles keep the counts right
+    auto nh = scores.extract(640);
+    nh.key() = 1'600;
+    scores.insert(std::move(nh));
+    auto const top = scores.nth(scores.size() - 1);
+    std::cout << "after fay's re-score, top: "s << top->second
+              << ", fay's position: "s << scores.index_of(top) << '\n';
+
+    cmapos::order_statistic_map<int, std::string> late { { 700, "ivy"s }, { 1'200, "X"s } };
+    scores.merge(late);
+    std::cout << "after merge: "s << scores.size() << " players, "s
+              << late.size() << " left in source\n"s;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapos::augmented_map - range aggregates"s << '\n';
+  {
+    using namespace cmapch;
+    using namespace std::chrono;
+
+    cmapos::augmented_map<year_month_day, int, cmapos::sum_of<int>> messages {
+      { February/17/2023 , 10 },
+      { February/16/2022 , 30 },
+      { October/22/2022  , 40 },
+      { June/14/2022     , 50 },
+      { November/23/2021 , 60 },
+      { December/10/2022 , 55 },
+      { December/12/2021 , 45 },
+      { April/1/2020     , 42 },
+    };
+
+    auto report = [&messages](year_month_day const & lo, year_month_day const & hi) {
+      std::cout << std::right << "messages in ["s << lo << ", "s << hi << "): "s
+                << messages.aggregate(lo, hi) << '\n';
+    };
+
+    report(January/1/2022, January/1/2023);
+    report(January/1/2021, January/1/2024);
+
+    // value updates go through a handle so the sums stay current
+    messages.update(June/14/2022, [](int & count) { count += 100; });
+    *messages.modify(messages.find(October/22/2022)) = 0;
+    messages.erase(December/10/2022);
+    report(January/1/2022, January/1/2023);
+    std::cout << "total: "s << messages.aggregate() << '\n';
+
+    cmapos::augmented_map<year_month_day, int, cmapos::max_of<int>> peak(
+      messages.begin(), messages.end());
+    std::cout << "busiest day before 2023: "s
+              << peak.aggregate(January/1/2020, January/1/2023) << " messages\n"s;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapts::timeseries_map - packed, chunked time keys"s << '\n';
+  {
+    using namespace cmapch;
+    using namespace std::chrono;
+
+    cmapts::timeseries_map<year_month_day, int> messages {
+      { February/17/2023 , 10 },
+      { February/17/2023 , 20 },
+      { February/16/2022 , 30 },
+      { October/22/2022  , 40 },
+      { June/14/2022     , 50 },
+      { November/23/2021 , 60 },
+      { December/10/2022 , 55 },
+      { December/12/2021 , 45 },
+      { April/1/2020     , 42 },
+      { April/1/2020     , 24 },
+    };
+
+    std::cout << std::right << "Messages received, reverse date order:\n"s;
+    for (auto kvpair = messages.crbegin(); kvpair != messages.crend(); ++kvpair) {
+      std::cout << kvpair->first << " : "s << kvpair->second << '\n';
+    }
+
+    auto const since = messages.lower_bound(January/1/2022);
+    std::cout << "first message of 2022 or later: "s
+              << since->first << " : "s << since->second << '\n';
+
+    // one sample a second for a day: each key appends in O(1)
+    cmapts::timeseries_map<sys_seconds, double> telemetry;
+    auto const t0 = sys_days(March/1/2023);
+    for (auto tick = 0; tick < 86'400; ++tick) {
+      telemetry.try_emplace(t0 + seconds(tick), std::sin(tick / 3600.0));
+    }
+    std::cout << "telemetry samples: "s << telemetry.size()
+              << " in "s << telemetry.chunk_count() << " chunks, "s
+              << telemetry.key_bytes() << " key bytes ("s
+              << std::fixed << std::setprecision(2)
+              << static_cast<double>(telemetry.key_bytes()) / telemetry.size()
+              << " per key)\n"s << std::defaultfloat;
+
+    auto const noon = telemetry.lower_bound(t0 + 12h);
+    std::cout << "at noon: "s << noon->second << '\n';
+
+    // retention: whole chunks are dropped without decoding
+    auto const dropped = telemetry.erase_before(t0 + 18h);
+    std::cout << "dropped "s << dropped << " samples, "s
+              << telemetry.size() << " left\n"s;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmappm::persistent_map - O(1) snapshots"s << '\n';
+  {
+    auto show = [](std::string_view label, auto const & cfg) {
+      std::cout << std::left << std::setw(10) << label << std::right << ": "s;
+      for (auto const & [key, value] : cfg) { std::cout << key << '=' << value << ' '; }
+      std::cout << '\n';
+    };
+
+    cmappm::persistent_map<std::string, int> config {
+      { "threads"s, 4 }, { "timeout"s, 30 }, { "retries"s, 3 },
+    };
+
+    // a copy is a snapshot: no nodes are duplicated
+    auto const reader = config;
+    config.insert_or_assign("timeout"s, 60);
+    config.erase("retries"s);
+    show("reader"s, reader);
+    show("config"s, config);
+
+    // bulk reload: the first edit on each path copies it, the rest are in place
+    config.batch([](auto & tx) {
+      for (auto key : { "cache"s, "queue"s, "workers"s }) { tx[key] = 16; }
+      tx.at("threads"s) *= 2;
+    });
+    show("reloaded"s, config);
+    show("reader"s, reader);
+
+    auto const trial = config.with("threads"s, 1);
+    std::cout << "trial threads: "s << trial.at("threads"s)
+              << ", config threads: "s << config.at("threads"s)
+              << ", same version: "s << std::boolalpha
+              << config.shares_root_with(config.snapshot()) << std::noboolalpha << '\n';
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmaprcu::rcu_map - wait-free readers, batched writers"s << '\n';
+  {
+    cmaprcu::rcu_map<int, std::string> coins {
+      {  10, "dime"s        },
+      { 100, "dollar"s      },
+      {  50, "half dollar"s },
+      {   5, "nickel"s      },
+      {   1, "penny"s       },
+      {  25, "quarter"s     },
+    };
+
+    auto show = [&coins] {
+      coins.read([](auto const & snap) {
+        for (auto it = snap.crbegin(); it != snap.crend(); ++it) {
+          std::cout << std::setw(11) << it->second << " = ¢"s << it->first << '\n';
+        }
+      });
+    };
+
+    // a pinned snapshot stays valid while the writer publishes
+    auto const pinned = coins.pin();
+
+    coins.erase(100);
+    coins.insert_or_assign(200, "two dollars"s);
+    std::cout << "staged changes: "s << coins.pending() << '\n';
+    coins.publish();
+
+    std::cout << "pinned version holds "s << pinned->size() << " coins, dollar: "s
+              << pinned->at(100) << '\n';
+    std::cout << "published version "s << coins.version() << ":\n"s;
+    show();
+    std::cout << "retired versions awaiting readers: "s << coins.retired() << '\n';
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmaprec::recycling_map - node handle reuse"s << '\n';
+  {
+    cmaprec::recycling_map<int, std::string> sessions;
+    for (auto id = 1; id <= 8; ++id) { sessions.try_emplace(id, "user-"s + std::to_string(id)); }
+
+    // churn: the oldest session closes, a new one opens
+    for (auto id = 9; id <= 1'000; ++id) {
+      sessions.erase(id - 8);
+      sessions.try_emplace(id, "user-"s + std::to_string(id));
+    }
+
+    for (auto const & [id, name] : sessions) { std::cout << id << ':' << name << ' '; }
+    std::cout << '\n';
+
+    auto const & stats = sessions.stats();
+    std::cout << "allocated: "s << stats.allocated << ", reused: "s << stats.reused
+              << ", reuse rate: "s << std::fixed << std::setprecision(1)
+              << stats.reuse_rate() * 100.0 << "%\n"s << std::defaultfloat;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapio::load_map - pipelined read / parse / insert"s << '\n';
+  {
+    auto const path = std::filesystem::temp_directory_path() / "cf_stl_maps_words.csv"s;
+    {
+      std::ofstream out(path);
+      auto const words = { "alpha"s, "bravo"s, "charlie"s, "delta"s, "echo"s, "foxtrot"s };
+      for (auto i_ = 0; i_ < 30'000; ++i_) {
+        out << *std::next(words.begin(), i_ % 6) << '-' << i_ % 5'000 << ',' << i_ << '\n';
+      }
+    }
+
+    // "key,value" -> pair; anything else is skipped
+    auto parse = [](std::string_view line) -> std::optional<std::pair<std::string, int>> {
+      auto const comma = line.find(',');
+      if (comma == std::string_view::npos) { return std::nullopt; }
+      auto value = 0;
+      std::from_chars(line.data() + comma + 1, line.data() + line.size(), value);
+      return std::pair(std::string(line.substr(0, comma)), value);
+    };
+
+    cmapio::thread_pool pool;
+    cmapio::load_options opts;
+    opts.chunk_bytes = 64 * 1'024;
+    auto runs = 0;
+    opts.on_progress = [&runs](cmapio::load_progress const &) { ++runs; };
+
+    auto loader = cmapio::load_map<std::map<std::string, int>>(pool, path, parse, opts);
+    auto const words = loader.get();
+    auto const progress = loader.progress();
+    std::cout << "read "s << progress.bytes_read << " of "s << progress.bytes_total
+              << " bytes, "s << progress.records_parsed << " records in "s << runs
+              << " sorted runs -> "s << words.size() << " keys\n"s;
+    std::cout << "first: "s << words.begin()->first << " = "s << words.begin()->second
+              << ", last: "s << words.rbegin()->first << " = "s << words.rbegin()->second << '\n';
+
+    // the same load awaited from a coroutine
+    auto count_keys = [&]() -> cmapio::task<std::size_t> {
+      auto reloaded = co_await cmapio::load_map<std::map<std::string, int>>(pool, path, parse);
+      co_return reloaded.size();
+    };
+    std::cout << "co_await reload: "s << cmapio::sync_wait(count_keys()) << " keys\n"s;
+
+    std::filesystem::remove(path);
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapws::parallel_for_each / parallel_reduce"s << '\n';
+  {
+    struct Point {
+      double x_val;
+      double y_val;
+    };
+    struct PointCmp {
+      bool operator()(Point const * lhs, Point const * rhs) const {
+        return lhs->x_val < rhs->x_val;
+      }
+    };
+
+    std::vector<Point> points;
+    for (auto i_ = 0; i_ < 10'000; ++i_) { points.push_back({ i_ * 0.5, 3.0 }); }
+
+    std::map<Point *, double, PointCmp> mag;
+    for (auto & point : points) { mag.emplace_hint(mag.end(), &point, 0.0); }
+
+    // values updated in place, one leaf of ~grain nodes per task
+    cmapws::parallel_for_each(mag, [](auto & kvpair) {
+      kvpair.second = std::hypot(kvpair.first->x_val, kvpair.first->y_val);
+    }, { .grain = 512 });
+
+    auto const first = mag.begin();
+    std::cout << std::setprecision(6) << "The magnitude of ("s << first->first->x_val << ", "s
+              << first->first->y_val << ") is "s << first->second << '\n';
+
+    // combine runs in key order: the first x with magnitude above 100
+    auto const over = cmapws::parallel_reduce(mag, std::optional<double> {},
+      [](auto const & kvpair) {
+        return kvpair.second > 100.0 ? std::optional(kvpair.first->x_val) : std::nullopt;
+      },
+      [](std::optional<double> lhs, std::optional<double> rhs) { return lhs ? lhs : rhs; });
+    std::cout << "first x with magnitude > 100: "s << over.value_or(-1.0)
+              << " (pool threads: "s << cmapws::work_stealing_pool::shared().size() << ")\n"s;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapview - keys, values, range, filter, zip"s << '\n';
+  {
+    using namespace cmap;
+
+    std::map<int, std::string> stock {
+      { 1, "apple"s }, { 3, "cherry"s }, { 4, "damson"s },
+      { 7, "grape"s }, { 9, "kiwi"s }, { 12, "mango"s },
+    };
+    std::map<int, double> price {
+      { 1, 0.40 }, { 3, 4.50 }, { 4, 3.25 }, { 7, 2.10 }, { 9, 0.35 }, { 12, 1.80 },
+    };
+
+    std::cout << "keys:"s;
+    for (auto const & key : cmapview::keys(stock)) { std::cout << ' ' << key; }
+    std::cout << '\n';
+
+    // mapped values are references into the map
+    for (auto & name : cmapview::values(stock)) { name[0] = static_cast<char>(std::toupper(name[0])); }
+
+    std::cout << "range [3, 9):"s;
+    for (auto const & [key, name] : cmapview::range(stock, 3, 9)) { std::cout << ' ' << key << '=' << name; }
+    std::cout << '\n';
+
+    auto short_names = [](auto const & kvpair) { return kvpair.second.size() <= 5; };
+    std::cout << "short names in [3, 12]:"s;
+    for (auto const & key : cmapview::keys(cmapview::filter(cmapview::range(stock, 3, 13), short_names))) {
+      std::cout << ' ' << key;
+    }
+    std::cout << '\n';
+
+    std::cout << "zip:"s << std::fixed << std::setprecision(2);
+    for (auto const & [item, cost] : cmapview::zip(stock, price)) {
+      std::cout << ' ' << item.second << '@' << cost.second;
+    }
+    std::cout << std::defaultfloat << std::setprecision(6) << '\n';
+
+    // sorted input: every emplace_hint(end()) is exact
+    auto const cheap = cmapview::to_map(cmapview::filter(price, [](auto const & kvpair) {
+      return kvpair.second < 1.0;
+    }));
+    std::cout << "cheap: "s << cheap;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapsm::small_map - inline storage for a few elements"s << '\n';
+  {
+    // sized like example, cont, nums: no allocation up to 4 elements
+    cmapsm::small_map<int, char, 4> cont {
+      { 1, 'a' }, { 2, 'b' }, { 3, 'c' },
+    };
+    cont[4] = 'd';
+    std::cout << "size: "s << cont.size() << ", inline: "s << std::boolalpha << cont.is_inline()
+              << ", sizeof: "s << sizeof(cont) << '\n';
+
+    for (auto const & [key, value] : cont) { std::cout << key << ':' << value << ' '; }
+    std::cout << '\n';
+
+    auto it = cont.lower_bound(3);
+    std::cout << "lower_bound(3): "s << it->first << ':' << it->second
+              << ", contains(7): "s << cont.contains(7) << '\n';
+
+    // the fifth element moves everything to a std::map
+    cont.try_emplace(5, 'e');
+    std::cout << "size: "s << cont.size() << ", inline: "s << cont.is_inline() << '\n';
+    cont.erase(cont.begin());
+    cont.clear();
+    cont.insert({ 9, 'z' });
+    std::cout << "after clear: inline: "s << cont.is_inline() << ", first: "s
+              << cont.begin()->first << ':' << cont.begin()->second << std::noboolalpha << '\n';
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapmv::bucket_multimap - one node, one bucket per key"s << '\n';
+  {
+    using namespace cmap;
+
+    // the erase_if data again: std::map dropped { 4, 'f' } and { 5, 'g' }
+    cmapmv::bucket_multimap<int, char> data {
+      { 1, 'a' }, { 2, 'b' }, { 3, 'c' }, { 4, 'd' },
+      { 5, 'e' }, { 4, 'f' }, { 5, 'g' }, { 5, 'g' },
+    };
+    std::cout << "Original:\n"s << data
+              << data.size() << " values under "s << data.key_count() << " keys\n"s;
+
+    std::cout << "equal_range(5):"s;
+    for (auto value : data.equal_range(5)) { std::cout << ' ' << value; }
+    std::cout << '\n';
+
+    auto const count = erase_if(data, [](auto const & item) {
+      auto const & [key, value] = item;
+      return (key & 1) == 1;
+    });
+    std::cout << "Erase items with odd keys:\n"s << data << count << " items removed.\n"s;
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapinst::instrumented_map - counts, latencies, hot keys"s << '\n';
+  {
+    // its own stats, apart from the traced_map sections of C_map()
+    auto stats = std::make_shared<cmapinst::map_stats<std::string>>(
+      cmapinst::map_stats<std::string>::options { .top_k = 8, .sample_every = 1 });
+    cmapinst::instrumented_map<std::string, std::size_t> word_map(stats);
+    {
+      // final dump when it goes out of scope
+      cmapinst::periodic_dump dump(std::chrono::seconds(1), [&stats] {
+        std::cout << stats->take_snapshot();
+      });
+
+      for (auto const & word : {
+        "this"s, "sentence"s, "is"s, "not"s, "a"s, "sentence"s,
+        "this"s, "sentence"s, "is"s, "a"s, "hoax"s
+      }) {
+        ++word_map[word];
+      }
+      word_map.emplace_hint(word_map.end(), "zebra"s, 0);   // exact: sorts last
+      word_map.emplace_hint(word_map.end(), "aardvark"s, 0); // wrong
+      try {
+        auto const truth = word_map.at("truth"s);
+        std::cout << "truth: "s << truth << '\n';
+      }
+      catch (std::out_of_range const &) { std::cout << "no truth\n"s; }
+      word_map.erase("hoax"s);
+    }
+    std::cout << "traced_map is std::map: "s << std::boolalpha
+              << std::is_same_v<cmapinst::traced_map<int, int>, std::map<int, int>>
+              << std::noboolalpha << '\n';
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmaphint::profiled_map - hint accuracy per call site"s << '\n';
+  {
+    auto & registry = cmaphint::hint_registry::instance();
+    registry.reset();
+
+    // the emplace_hint strategies again; only the declaration changed
+    auto constexpr nof_operations = 1'000;
+    cmaphint::profiled_map<int, char> correct, wrong, corrected, closest;
+    for (int i_ = 0; i_ < nof_operations; ++i_) { correct.emplace_hint(correct.end(), i_, 'b'); }
+    for (int i_ = nof_operations; i_ > 0; --i_) { wrong.emplace_hint(wrong.end(), i_, 'c'); }
+    for (int i_ = nof_operations; i_ > 0; --i_) { corrected.emplace_hint(corrected.begin(), i_, 'd'); }
+    auto it = closest.begin();
+    for (int i_ = 0; i_ < nof_operations; ++i_) { it = closest.emplace_hint(it, i_, 'e'); }
+
+    // node handle moved between maps, hinted at its new neighbour
+    auto nh = wrong.extract(500);
+    correct.erase(500);
+    correct.insert(correct.find(501), std::move(nh));
+
+    for (auto const & site : registry.report()) {
+      std::cout << "line "s << site.line << ": "s << std::setw(5) << site.calls() << " calls, "s
+                << std::fixed << std::setprecision(1) << std::setw(5) << site.accuracy() * 100.0
+                << "% O(1), "s << site.count(cmaphint::outcome::miss) << " misses, "s
+                << site.count(cmaphint::outcome::after) << " after the hint\n"s
+                << std::defaultfloat << std::setprecision(6);
+    }
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapcmp::fast_less - comparators picked per key type"s << '\n';
+  {
+    using namespace cmapch;
+    using namespace std::chrono;
+
+    // the same order as std::less, so the same iteration
+    cmapcmp::fast_map<std::string, int> words {
+      { "something"s, 69 }, { "anything"s, 199 }, { "that thing"s, 50 }, { "any"s, 1 }, { "be"s, 2 },
+    };
+    std::cout << "fast_map<string>: "s;
+    for (auto const & [word, count] : words) { std::cout << word << ':' << count << ' '; }
+    std::cout << '\n';
+
+    // transparent: a string_view looks up without building a std::string
+    auto const probe = std::string_view("anything and more").substr(0, 8);
+    std::cout << "find(\""s << probe << "\"): "s << words.find(probe)->second << '\n';
+
+    // length first is faster on lengths that differ, but no longer alphabetical
+    std::map<std::string, int, cmapcmp::length_first_less> by_length(words.begin(), words.end());
+    std::cout << "length_first_less: "s;
+    for (auto const & [word, count] : by_length) { std::cout << word << ' '; }
+    std::cout << '\n';
+
+    cmapcmp::fast_map<year_month_day, int> const messages {
+      { February/17/2023, 10 }, { October/22/2022, 40 }, { April/1/2020, 42 },
+    };
+    std::cout << "fast_map<year_month_day>: "s;
+    for (auto const & [date, count] : messages) { std::cout << date << ' ' << count << "  "s; }
+    std::cout << '\n';
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapnuma::numa_map - key ranges partitioned over NUMA nodes"s << '\n';
+  {
+    std::cout << "NUMA nodes: "s << cmapnuma::topology::nodes()
+              << (cmapnuma::have_libnuma ? " (libnuma)"s : " (no libnuma)"s) << '\n';
+
+    // four partitions even on one node, to show the routing
+    cmapnuma::numa_map<int, std::string> routed({ .partitions = 4 });
+    std::vector<std::pair<int, std::string>> load;
+    for (int key = 0; key < 1000; ++key) { load.emplace_back(key, "v"s + std::to_string(key)); }
+    routed.insert_or_assign(load.begin(), load.end());
+
+    auto show = [&routed](std::string_view when) {
+      std::cout << when << ": sizes"s;
+      for (auto size : routed.partition_sizes()) { std::cout << ' ' << size; }
+      std::cout << ", imbalance "s << std::fixed << std::setprecision(2) << routed.imbalance()
+                << std::defaultfloat << std::setprecision(6) << '\n';
+    };
+    show("loaded"s);   // no bounds yet: all in partition 0
+    std::cout << "rebalance moved "s << routed.rebalance() << '\n';
+    show("rebalanced"s);
+
+    std::cout << "get(600): "s << routed.get(600).value_or("-"s)
+              << " in partition "s << routed.partition_of(600)
+              << " on node "s << routed.node_of(routed.partition_of(600)) << '\n';
+
+    // runs on partition 3's worker, next to its data
+    auto evens = routed.submit(999, [](auto & part) {
+      return std::erase_if(part, [](auto const & item) { return item.first % 2 == 0; });
+    });
+    std::cout << "erased on the worker: "s << evens.get() << ", size "s << routed.size() << '\n';
+
+    std::cout << '\n';
+  }
+
+  // ....+....!....+....!....+....!....+....!....+....!....+....!
+  std::cout << konst::dot << '\n';
+  std::cout << "cmapcache::cache_map - bounded LRU / W-TinyLFU cache"s << '\n';
+  {
+    using namespace cmapfd;
+
+    // FatKey entries found with a LightKey, as with std::map<FatKey, char, std::less<>>
+    cmapcache::cache_map<FatKey, char, std::less<>, cmapcache::lru> fat({ .max_entries = 2 });
+    fat.insert_or_assign(FatKey { 1, {} }, 'a');
+    fat.insert_or_assign(FatKey { 2, {} }, 'b');
+    fat.find(LightKey { 1 });                        // 1 is now the most recent
+    fat.insert_or_assign(FatKey { 3, {} }, 'c');     // so 2 goes
+    std::cout << "lru, 2 entries: "s;
+    fat.for_each([](FatKey const & key, char value) { std::cout << key.x << ':' << value << ' '; });
+    std::cout << "(" << fat.bytes() << " bytes)\n"s << fat.stats() << '\n';
+
+    // a byte budget counting the strings' buffers too
+    auto weigher = [](std::string const & key, std::string const & value) {
+      return key.capacity() + value.capacity();
+    };
+    cmapcache::cache_map<std::string, std::string, std::less<>,
+                         cmapcache::w_tinylfu<>, decltype(weigher)> pages({ .max_bytes = 16 * 1024 }, {}, weigher);
+
+    // a few popular pages, then a scan of one-off pages that would flush an LRU
+    for (int round = 0; round < 20; ++round) {
+      for (int page = 0; page < 8; ++page) {
+        auto const url = "/popular/"s + std::to_string(page);
+        if (!pages.find(std::string_view(url))) { pages.insert_or_assign(url, std::string(1'000, 'p')); }
+      }
+    }
+    for (int page = 0; page < 200; ++page) {
+      auto const url = "/scan/"s + std::to_string(page);
+      if (!pages.find(std::string_view(url))) { pages.insert_or_assign(url, std::string(1'000, 's')); }
+    }
+    auto popular = 0;
+    pages.for_each([&popular](std::string const & url, auto const &) { popular += url.starts_with("/popular/"); });
+    std::cout << "w_tinylfu, 16 KiB: "s << pages.size() << " entries, "s << pages.bytes() << " bytes, "s
+              << popular << " of 8 popular pages kept\n"s << pages.stats() << '\n';
+
+    std::cout << '\n';
+  }
+
   std::cout << std::endl; //  make sure cout is flushed.
 
   return 0;
@@ -0,0 +1,384 @@
+//
+//  numa_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://man7.org/linux/man-pages/man3/numa.3.html
+//  @see: https://en.cppreference.com/w/cpp/memory/unsynchronized_pool_resource
+//  @see: https://en.cppreference.com/w/cpp/thread/shared_mutex
+//
+
+#ifndef numa_map_hpp
+#define numa_map_hpp
+
+#include <map>
+#include <memory_resource>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <future>
+#include <optional>
+#include <algorithm>
+#include <numeric>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include <cstddef>
+
+#include "map_loader.hpp"
+
+//  CMAP_HAVE_LIBNUMA=1 (set by CMakeLists.txt when libnuma is found; link
+//  with -lnuma) places partitions on NUMA nodes.  At 0, or when the
+//  kernel reports no NUMA support, there is one node and plain new/delete.
+#ifndef CMAP_HAVE_LIBNUMA
+#define CMAP_HAVE_LIBNUMA 0
+#endif
+
+#if CMAP_HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapnuma
+namespace cmapnuma {
+
+inline constexpr bool have_libnuma = CMAP_HAVE_LIBNUMA != 0;
+
+/*
+ *  MARK: topology
+ *  The NUMA nodes that have memory, in id order (ids may have gaps).  A
+ *  single { 0 } without libnuma or on a single-node machine, where
+ *  binding a thread is a no-op.
+ */
+struct topology {
+  static auto node_ids() -> std::vector<unsigned> const & {
+    static auto const ids = [] {
+      std::vector<unsigned> found;
+#if CMAP_HAVE_LIBNUMA
+      if (numa_available() >= 0) {
+        for (int node = 0; node <= numa_max_node(); ++node) {
+          if (numa_bitmask_isbitset(numa_all_nodes_ptr, static_cast<unsigned>(node))) {
+            found.push_back(static_cast<unsigned>(node));
+          }
+        }
+      }
+#endif
+      if (found.empty()) { found.push_back(0); }
+      return found;
+    }();
+    return ids;
+  }
+
+  static auto nodes() -> std::size_t { return node_ids().size(); }
+
+  // run the calling thread on node's CPUs; false if nothing was done
+  static auto bind_thread(unsigned node) -> bool {
+#if CMAP_HAVE_LIBNUMA
+    if (nodes() > 1) { return numa_run_on_node(static_cast<int>(node)) == 0; }
+#endif
+    static_cast<void>(node);
+    return false;
+  }
+};
+
+/*
+ *  MARK: node_resource
+ *  Memory from one node: numa_alloc_onnode() pages, bound with mbind, so
+ *  they stay on the node whichever thread touches them first.  Page
+ *  granular, so it backs a pool rather than serving nodes directly.
+ */
+class node_resource : public std::pmr::memory_resource {
+public:
+  explicit node_resource(unsigned node) noexcept : node_(node) {}
+
+  auto node() const noexcept -> unsigned { return node_; }
+
+private:
+  auto do_allocate(std::size_t bytes, std::size_t align) -> void * override {
+#if CMAP_HAVE_LIBNUMA
+    if (topology::nodes() > 1) {
+      if (auto * mem = numa_alloc_onnode(bytes, static_cast<int>(node_))) { return mem; }  // page aligned
+      throw std::bad_alloc();
+    }
+#endif
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+
+  auto do_deallocate(void * mem, std::size_t bytes, std::size_t align) -> void override {
+#if CMAP_HAVE_LIBNUMA
+    if (topology::nodes() > 1) { numa_free(mem, bytes); return; }
+#endif
+    std::pmr::new_delete_resource()->deallocate(mem, bytes, align);
+  }
+
+  auto do_is_equal(std::pmr::memory_resource const & other) const noexcept -> bool override {
+    return this == &other;
+  }
+
+  unsigned node_;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: numa_map
+ *  Ordered map split by key range into partitions, each a std::pmr::map
+ *  whose nodes come from a pool on one NUMA node and each with one
+ *  worker thread bound to that node.  Partition i holds the keys in
+ *  [bounds[i-1], bounds[i]).
+ *    - get/insert/erase from any thread lock the owning partition only,
+ *      shared for reads; the data touched is local to the partition;
+ *    - submit(key, fn) runs fn on the owner's worker, so a batch of work
+ *      on one range runs on the node that holds it, and a bulk
+ *      insert_or_assign() fans out to every owner at once;
+ *    - rebalance() moves the bounds to the key distribution's quantiles
+ *      and migrates the elements; imbalance() says when that is due.
+ *  Partitions default to one per node: one on a single-node machine,
+ *  which is then a locked std::pmr::map with one extra thread.  More
+ *  may be asked for; they share nodes round-robin.
+ *
+ *  Every operation holds the layout lock shared, rebalance() holds it
+ *  exclusively.  Values are copied out (get), never referenced: a
+ *  reference would outlive the partition lock.
+ */
+struct numa_options {
+  std::size_t partitions = 0;   // 0: one per NUMA node
+};
+
+template <class Key, class T, class Compare = std::less<Key>>
+class numa_map {
+public:
+  using key_type    = Key;
+  using mapped_type = T;
+  using size_type   = std::size_t;
+  using key_compare = Compare;
+  using map_type    = std::pmr::map<Key, T, Compare>;
+
+  explicit numa_map(numa_options const & opts = {}, Compare const & comp = Compare()) : comp_(comp) {
+    auto const & nodes = topology::node_ids();
+    auto const count = opts.partitions == 0 ? nodes.size() : opts.partitions;
+    parts_.reserve(count);
+    for (size_type ix = 0; ix < count; ++ix) {
+      parts_.push_back(std::make_unique<partition>(nodes[ix % nodes.size()], comp_));
+    }
+  }
+
+  // queued work still sees a whole map: every worker drains before any partition goes
+  ~numa_map() {
+    for (size_type ix = 0; ix < parts_.size(); ++ix) { run_on(ix, [] {}).wait(); }
+  }
+
+  numa_map(numa_map const &) = delete;
+  auto operator=(numa_map const &) -> numa_map & = delete;
+
+  //  MARK: layout
+  auto partitions() const noexcept -> size_type { return parts_.size(); }
+  auto node_of(size_type partition) const -> unsigned { return parts_[partition]->upstream.node(); }
+
+  auto partition_of(Key const & key) const -> size_type {
+    auto layout = std::shared_lock(layout_mx_);
+    return index_of(key);
+  }
+
+  auto partition_sizes() const -> std::vector<size_type> {
+    auto layout = std::shared_lock(layout_mx_);
+    std::vector<size_type> sizes;
+    for (auto const & part : parts_) {
+      auto lock = std::shared_lock(part->mx);
+      sizes.push_back(part->map.size());
+    }
+    return sizes;
+  }
+
+  auto size() const -> size_type {
+    auto const sizes = partition_sizes();
+    return std::reduce(sizes.begin(), sizes.end(), size_type { 0 });
+  }
+
+  // largest partition over the mean: 1.0 is perfectly even
+  auto imbalance() const -> double {
+    auto const sizes = partition_sizes();
+    auto const total = std::reduce(sizes.begin(), sizes.end(), size_type { 0 });
+    if (total == 0) { return 1.0; }
+    auto const mean = static_cast<double>(total) / static_cast<double>(sizes.size());
+    return static_cast<double>(*std::max_element(sizes.begin(), sizes.end())) / mean;
+  }
+
+  //  MARK: lookup
+  auto get(Key const & key) const -> std::optional<T> {
+    auto layout = std::shared_lock(layout_mx_);
+    auto const & part = *parts_[index_of(key)];
+    auto lock = std::shared_lock(part.mx);
+    if (auto it = part.map.find(key); it != part.map.end()) { return it->second; }
+    return std::nullopt;
+  }
+
+  auto contains(Key const & key) const -> bool {
+    auto layout = std::shared_lock(layout_mx_);
+    auto const & part = *parts_[index_of(key)];
+    auto lock = std::shared_lock(part.mx);
+    return part.map.contains(key);
+  }
+
+  // fn(key, value) for every element in key order, one partition locked at a time
+  template <class Fn>
+  auto for_each(Fn fn) const -> void {
+    auto layout = std::shared_lock(layout_mx_);
+    for (auto const & part : parts_) {
+      auto lock = std::shared_lock(part->mx);
+      for (auto const & [key, value] : part->map) { fn(key, value); }
+    }
+  }
+
+  //  MARK: modifiers
+  template <class M>
+  auto insert_or_assign(Key const & key, M && obj) -> bool {
+    return with_owner(key, [&](map_type & map) { return map.insert_or_assign(key, std::forward<M>(obj)).second; });
+  }
+
+  template <class ... Args>
+  auto try_emplace(Key const & key, Args && ... args) -> bool {
+    return with_owner(key, [&](map_type & map) { return map.try_emplace(key, std::forward<Args>(args) ...).second; });
+  }
+
+  auto erase(Key const & key) -> size_type {
+    return with_owner(key, [&](map_type & map) { return map.erase(key); });
+  }
+
+  // fn(map_type &) on the owning partition's worker, under its lock
+  template <class Fn>
+  auto submit(Key const & key, Fn fn) -> std::future<std::invoke_result_t<Fn &, map_type &>> {
+    auto const ix = partition_of(key);
+    return run_on(ix, [this, ix, fn = std::move(fn)]() mutable {
+      auto layout = std::shared_lock(layout_mx_);
+      auto & part = *parts_[ix];
+      auto lock = std::unique_lock(part.mx);
+      return fn(part.map);
+    });
+  }
+
+  // bulk load: each owner's elements inserted by its own worker, in parallel
+  template <std::input_iterator It>
+  auto insert_or_assign(It first, It last) -> void {
+    std::vector<std::vector<std::pair<Key, T>>> batches(parts_.size());
+    {
+      auto layout = std::shared_lock(layout_mx_);
+      for (; first != last; ++first) { batches[index_of(first->first)].emplace_back(first->first, first->second); }
+    }
+
+    std::vector<std::future<std::vector<std::pair<Key, T>>>> done;
+    for (size_type ix = 0; ix < batches.size(); ++ix) {
+      if (batches[ix].empty()) { continue; }
+      done.push_back(run_on(ix, [this, ix, batch = std::move(batches[ix])]() mutable {
+        // a rebalance since the batching may have moved some keys away
+        std::vector<std::pair<Key, T>> strays;
+        auto layout = std::shared_lock(layout_mx_);
+        auto & part = *parts_[ix];
+        auto lock = std::unique_lock(part.mx);
+        for (auto & [key, value] : batch) {
+          if (index_of(key) == ix) { part.map.insert_or_assign(std::move(key), std::move(value)); }
+          else                     { strays.emplace_back(std::move(key), std::move(value)); }
+        }
+        return strays;
+      }));
+    }
+    // never wait while holding the layout lock: a queued rebalance would
+    //  block the workers' shared locks
+    for (auto & batch : done) {
+      for (auto & [key, value] : batch.get()) { insert_or_assign(key, std::move(value)); }
+    }
+  }
+
+  auto clear() -> void {
+    auto layout = std::shared_lock(layout_mx_);
+    for (auto const & part : parts_) {
+      auto lock = std::unique_lock(part->mx);
+      part->map.clear();
+    }
+  }
+
+  //  MARK: rebalance()
+  // bounds to the quantiles of the keys now held; returns the elements moved
+  auto rebalance() -> size_type {
+    auto layout = std::unique_lock(layout_mx_);   // no operation is inside a partition
+    if (parts_.size() < 2) { return 0; }
+
+    size_type total = 0;
+    for (auto const & part : parts_) { total += part->map.size(); }
+    if (total == 0) { return 0; }
+
+    std::vector<Key> bounds;
+    size_type seen = 0;
+    for (auto const & part : parts_) {
+      for (auto const & [key, value] : part->map) {
+        // the first key of partition k + 1 sits at position (k + 1) * total / partitions
+        if (seen * parts_.size() >= (bounds.size() + 1) * total && bounds.size() + 1 < parts_.size()) {
+          bounds.push_back(key);
+        }
+        ++seen;
+      }
+    }
+    bounds_ = std::move(bounds);
+
+    size_type moved = 0;
+    for (size_type ix = 0; ix < parts_.size(); ++ix) {
+      auto & map = parts_[ix]->map;
+      for (auto it = map.begin(); it != map.end(); ) {
+        auto const owner = index_of(it->first);
+        if (owner == ix) { ++it; continue; }
+        // another pool, so the node is copied, not spliced
+        parts_[owner]->map.emplace(it->first, std::move(it->second));
+        it = map.erase(it);
+        ++moved;
+      }
+    }
+    return moved;
+  }
+
+private:
+  struct partition {
+    partition(unsigned node, Compare const & comp)
+      : upstream(node), pool(&upstream), map(comp, &pool), worker(1) {
+      worker.post([node] { topology::bind_thread(node); });   // first in its queue
+    }
+
+    node_resource                          upstream;
+    std::pmr::unsynchronized_pool_resource pool;     // guarded by mx
+    map_type                               map;
+    mutable std::shared_mutex              mx;
+    cmapio::thread_pool                    worker;   // last: joined before the map dies
+  };
+
+  // callers hold layout_mx_
+  auto index_of(Key const & key) const -> size_type {
+    return static_cast<size_type>(std::upper_bound(bounds_.begin(), bounds_.end(), key, comp_) - bounds_.begin());
+  }
+
+  template <class Fn>
+  auto with_owner(Key const & key, Fn && fn) -> decltype(auto) {
+    auto layout = std::shared_lock(layout_mx_);
+    auto & part = *parts_[index_of(key)];
+    auto lock = std::unique_lock(part.mx);
+    return fn(part.map);
+  }
+
+  template <class Fn>
+  auto run_on(size_type ix, Fn fn) -> std::future<std::invoke_result_t<Fn &>> {
+    auto work = std::make_shared<std::packaged_task<std::invoke_result_t<Fn &>()>>(std::move(fn));
+    auto result = work->get_future();
+    parts_[ix]->worker.post([work] { (*work)(); });
+    return result;
+  }
+
+  Compare                                 comp_;
+  mutable std::shared_mutex               layout_mx_;
+  std::vector<Key>                        bounds_;   // first key of partitions 1 ..
+  std::vector<std::unique_ptr<partition>> parts_;
+};
+
+} /* namespace cmapnuma */
+
+#endif /* numa_map_hpp */
@@ -0,0 +1,829 @@
+//
+//  order_statistic_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: Cormen et al., "Introduction to Algorithms", 14.1 Dynamic order statistics
+//  @see: https://en.cppreference.com/w/cpp/container/node_handle
+//  @see: https://en.wikipedia.org/wiki/Monoid
+//
+
+#ifndef order_statistic_map_hpp
+#define order_statistic_map_hpp
+
+#include <utility>
+#include <tuple>
+#include <functional>
+#include <iterator>
+#include <initializer_list>
+#include <stdexcept>
+#include <algorithm>
+#include <compare>
+#include <concepts>
+#include <limits>
+#include <type_traits>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapos
+namespace cmapos {
+
+/*
+ *  MARK: Monoids
+ *  A subtree aggregate: value_type, an identity(), an associative
+ *  combine(lhs, rhs) applied in key order, and lift(key, mapped) for one
+ *  element.  no_aggregate (the default) costs nothing per node.
+ */
+struct no_aggregate {
+  struct value_type {
+    friend constexpr bool operator==(value_type, value_type) { return true; }
+  };
+  static constexpr auto identity() -> value_type { return {}; }
+  static constexpr auto combine(value_type, value_type) -> value_type { return {}; }
+  template <class K, class V>
+  static constexpr auto lift(K const &, V const &) -> value_type { return {}; }
+};
+
+template <class V>
+struct sum_of {
+  using value_type = V;
+  static constexpr auto identity() -> V { return V {}; }
+  static constexpr auto combine(V const & lhs, V const & rhs) -> V { return lhs + rhs; }
+  template <class K>
+  static constexpr auto lift(K const &, V const & value) -> V { return value; }
+};
+
+template <class V>
+struct min_of {
+  using value_type = V;
+  static constexpr auto identity() -> V { return std::numeric_limits<V>::max(); }
+  static constexpr auto combine(V const & lhs, V const & rhs) -> V { return std::min(lhs, rhs); }
+  template <class K>
+  static constexpr auto lift(K const &, V const & value) -> V { return value; }
+};
+
+template <class V>
+struct max_of {
+  using value_type = V;
+  static constexpr auto identity() -> V { return std::numeric_limits<V>::lowest(); }
+  static constexpr auto combine(V const & lhs, V const & rhs) -> V { return std::max(lhs, rhs); }
+  template <class K>
+  static constexpr auto lift(K const &, V const & value) -> V { return value; }
+};
+
+/*
+ *  MARK: order_statistic_map
+ *  Ordered map on an AVL tree whose nodes also record their subtree size,
+ *  giving O(log n)
+ *    nth(k)              -> iterator to the k-th smallest element (0-based)
+ *    rank(key)           -> number of elements with key < key
+ *    count_range(lo, hi) -> number of elements with lo <= key < hi
+ *  Sizes are maintained on every path that insert, erase, extract,
+ *  node-handle insert and merge touch.  Iterators and references are
+ *  stable as for std::map: rebalancing relinks nodes, never moves values.
+ *
+ *  With a Monoid other than no_aggregate every node also stores the
+ *  aggregate of its subtree, and aggregate(lo, hi) folds the elements with
+ *  lo <= key < hi in O(log n).  Mapped values then become read-only
+ *  through iterators (as keys are in std::set); change them with update(),
+ *  modify() or insert_or_assign() so the aggregates along the path follow.
+ */
+template <class Key, class T,
+          class Compare = std::less<Key>,
+          class Monoid = no_aggregate>
+class order_statistic_map {
+public:
+  using key_type        = Key;
+  using mapped_type     = T;
+  using value_type      = std::pair<Key const, T>;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare     = Compare;
+  using reference       = value_type &;
+  using const_reference = value_type const &;
+  using monoid_type     = Monoid;
+  using aggregate_type  = typename Monoid::value_type;
+
+  static constexpr bool augmented = !std::is_same_v<Monoid, no_aggregate>;
+
+private:
+  struct node_base {
+    node_base *  parent = nullptr;
+    node_base *  left   = nullptr;
+    node_base *  right  = nullptr;
+    size_type    size   = 0;
+    std::int8_t  height = 0;
+    [[no_unique_address]] aggregate_type agg = Monoid::identity();
+  };
+
+  struct node : node_base {
+    template <class ... Args>
+    explicit node(Args && ... args) : value(std::forward<Args>(args) ...) {
+      update(this);
+    }
+    value_type value;
+  };
+
+  static auto as_node(node_base const * nb) -> node * {
+    return static_cast<node *>(const_cast<node_base *>(nb));
+  }
+  static auto key_of(node_base const * nb) -> key_type const & {
+    return as_node(nb)->value.first;
+  }
+  static auto size_of(node_base const * nb) -> size_type { return nb ? nb->size : 0; }
+  static auto height_of(node_base const * nb) -> int { return nb ? nb->height : 0; }
+  static auto agg_of(node_base const * nb) -> aggregate_type {
+    return nb ? nb->agg : Monoid::identity();
+  }
+  static auto lift(node_base const * nb) -> aggregate_type {
+    return Monoid::lift(as_node(nb)->value.first, as_node(nb)->value.second);
+  }
+
+public:
+  //  MARK: iterator
+  template <bool Const>
+  class basic_iterator {
+    friend class order_statistic_map;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = order_statistic_map::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer   = std::conditional_t<Const, value_type const *, value_type *>;
+    using reference = std::conditional_t<Const, value_type const &, value_type &>;
+
+    basic_iterator() = default;
+    explicit basic_iterator(node_base const * cur) : cur_(cur) {}
+    template <bool C = Const> requires C
+    basic_iterator(basic_iterator<false> const & other) : cur_(other.cur_) {}
+
+    auto operator*() const -> reference { return as_node(cur_)->value; }
+    auto operator->() const -> pointer { return &as_node(cur_)->value; }
+    auto operator++() -> basic_iterator & { cur_ = successor(cur_); return *this; }
+    auto operator++(int) -> basic_iterator { auto tmp = *this; ++*this; return tmp; }
+    auto operator--() -> basic_iterator & { cur_ = predecessor(cur_); return *this; }
+    auto operator--(int) -> basic_iterator { auto tmp = *this; --*this; return tmp; }
+
+    friend bool operator==(basic_iterator const &, basic_iterator const &) = default;
+
+  private:
+    node_base const * cur_ = nullptr;
+    friend class basic_iterator<!Const>;
+  };
+
+  using iterator               = basic_iterator<augmented>;
+  using const_iterator         = basic_iterator<true>;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  //  MARK: node_type
+  class node_type {
+    friend class order_statistic_map;
+
+  public:
+    using key_type    = order_statistic_map::key_type;
+    using mapped_type = order_statistic_map::mapped_type;
+
+    node_type() = default;
+    node_type(node_type && other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+    auto operator=(node_type && other) noexcept -> node_type & {
+      if (this != &other) { reset(); ptr_ = std::exchange(other.ptr_, nullptr); }
+      return *this;
+    }
+    ~node_type() { reset(); }
+
+    [[nodiscard]] auto empty() const noexcept -> bool { return ptr_ == nullptr; }
+    explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+    // as with std::map::node_type, the key is writable while detached
+    auto key() const -> key_type & { return const_cast<key_type &>(ptr_->value.first); }
+    auto mapped() const -> mapped_type & { return ptr_->value.second; }
+
+  private:
+    explicit node_type(node * ptr) : ptr_(ptr) {}
+    auto release() -> node * { return std::exchange(ptr_, nullptr); }
+    auto reset() -> void { delete std::exchange(ptr_, nullptr); }
+
+    node * ptr_ = nullptr;
+  };
+
+  struct insert_return_type {
+    iterator  position;
+    bool      inserted;
+    node_type node;
+  };
+
+  //  MARK: construction
+  order_statistic_map() = default;
+
+  explicit order_statistic_map(Compare const & comp) : comp_(comp) {}
+
+  order_statistic_map(std::initializer_list<value_type> init, Compare const & comp = Compare())
+    : comp_(comp) {
+    insert(init);
+  }
+
+  template <std::input_iterator It>
+  order_statistic_map(It first, It last, Compare const & comp = Compare()) : comp_(comp) {
+    insert(first, last);
+  }
+
+  order_statistic_map(order_statistic_map const & other) : comp_(other.comp_) {
+    set_root(clone(other.root(), &header_));
+  }
+
+  order_statistic_map(order_statistic_map && other) noexcept : comp_(other.comp_) {
+    set_root(other.root());
+    other.set_root(nullptr);
+  }
+
+  auto operator=(order_statistic_map const & other) -> order_statistic_map & {
+    if (this != &other) {
+      order_statistic_map tmp(other);
+      swap(tmp);
+    }
+    return *this;
+  }
+
+  auto operator=(order_statistic_map && other) noexcept -> order_statistic_map & {
+    if (this != &other) {
+      clear();
+      comp_ = other.comp_;
+      set_root(other.root());
+      other.set_root(nullptr);
+    }
+    return *this;
+  }
+
+  auto operator=(std::initializer_list<value_type> init) -> order_statistic_map & {
+    clear();
+    insert(init);
+    return *this;
+  }
+
+  ~order_statistic_map() { clear(); }
+
+  //  MARK: iterators
+  auto begin()        noexcept -> iterator       { return iterator(leftmost()); }
+  auto end()          noexcept -> iterator       { return iterator(&header_); }
+  auto begin()  const noexcept -> const_iterator { return const_iterator(leftmost()); }
+  auto end()    const noexcept -> const_iterator { return const_iterator(&header_); }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend()   const noexcept -> const_iterator { return end(); }
+  auto rbegin()        noexcept { return reverse_iterator(end()); }
+  auto rend()          noexcept { return reverse_iterator(begin()); }
+  auto rbegin()  const noexcept { return const_reverse_iterator(end()); }
+  auto rend()    const noexcept { return const_reverse_iterator(begin()); }
+  auto crbegin() const noexcept { return rbegin(); }
+  auto crend()   const noexcept { return rend(); }
+
+  //  MARK: capacity
+  [[nodiscard]] auto empty() const noexcept -> bool { return root() == nullptr; }
+  auto size() const noexcept -> size_type { return size_of(root()); }
+  auto key_comp() const -> key_compare { return comp_; }
+
+  //  MARK: order statistics
+  auto nth(size_type index) -> iterator {
+    return iterator(const_cast<node_base *>(select(index)));
+  }
+  auto nth(size_type index) const -> const_iterator { return const_iterator(select(index)); }
+
+  // number of elements whose key is less than key
+  auto rank(key_type const & key) const -> size_type {
+    size_type below = 0;
+    for (auto * cur = root(); cur; ) {
+      if (comp_(key_of(cur), key)) {
+        below += size_of(cur->left) + 1;
+        cur = cur->right;
+      }
+      else {
+        cur = cur->left;
+      }
+    }
+    return below;
+  }
+
+  // zero-based position of the element at pos (size() for end())
+  auto index_of(const_iterator pos) const -> size_type {
+    auto const * cur = pos.cur_;
+    if (cur == &header_) { return size(); }
+    auto index = size_of(cur->left);
+    for (; cur->parent != &header_; cur = cur->parent) {
+      if (cur == cur->parent->right) { index += size_of(cur->parent->left) + 1; }
+    }
+    return index;
+  }
+
+  // number of elements with lo <= key < hi
+  auto count_range(key_type const & lo, key_type const & hi) const -> size_type {
+    if (!comp_(lo, hi)) { return 0; }
+    return rank(hi) - rank(lo);
+  }
+
+  //  MARK: lookup
+  auto find(key_type const & key) -> iterator {
+    auto it = lower_bound(key);
+    return it == end() || comp_(key, it->first) ? end() : it;
+  }
+  auto find(key_type const & key) const -> const_iterator {
+    return const_cast<order_statistic_map *>(this)->find(key);
+  }
+  auto contains(key_type const & key) const -> bool { return find(key) != end(); }
+  auto count(key_type const & key) const -> size_type { return contains(key) ? 1 : 0; }
+
+  auto at(key_type const & key) -> mapped_type & requires (!augmented) {
+    auto it = find(key);
+    if (it == end()) { throw std::out_of_range("order_statistic_map::at"); }
+    return it->second;
+  }
+  auto at(key_type const & key) const -> mapped_type const & {
+    auto it = find(key);
+    if (it == end()) { throw std::out_of_range("order_statistic_map::at"); }
+    return it->second;
+  }
+
+  auto lower_bound(key_type const & key) -> iterator {
+    node_base * found = &header_;
+    for (auto * cur = root(); cur; ) {
+      if (!comp_(key_of(cur), key)) { found = cur; cur = cur->left; }
+      else                          { cur = cur->right; }
+    }
+    return iterator(found);
+  }
+  auto lower_bound(key_type const & key) const -> const_iterator {
+    return const_cast<order_statistic_map *>(this)->lower_bound(key);
+  }
+
+  auto upper_bound(key_type const & key) -> iterator {
+    node_base * found = &header_;
+    for (auto * cur = root(); cur; ) {
+      if (comp_(key, key_of(cur))) { found = cur; cur = cur->left; }
+      else                         { cur = cur->right; }
+    }
+    return iterator(found);
+  }
+  auto upper_bound(key_type const & key) const -> const_iterator {
+    return const_cast<order_statistic_map *>(this)->upper_bound(key);
+  }
+
+  auto equal_range(key_type const & key) -> std::pair<iterator, iterator> {
+    return { lower_bound(key), upper_bound(key) };
+  }
+  auto equal_range(key_type const & key) const -> std::pair<const_iterator, const_iterator> {
+    return { lower_bound(key), upper_bound(key) };
+  }
+
+  //  MARK: modifiers
+  template <class ... Args>
+  auto emplace(Args && ... args) -> std::pair<iterator, bool> {
+    auto * fresh = new node(std::forward<Args>(args) ...);
+    auto const [parent, left] = find_slot(fresh->value.first);
+    if (parent == nullptr) {
+      auto existing = lower_bound(fresh->value.first);
+      delete fresh;
+      return { existing, false };
+    }
+    attach(fresh, parent, left);
+    return { iterator(fresh), true };
+  }
+
+  template <class ... Args>
+  auto emplace_hint(const_iterator, Args && ... args) -> iterator {
+    return emplace(std::forward<Args>(args) ...).first;
+  }
+
+  template <class K, class ... Args>
+  auto try_emplace(K && key, Args && ... args) -> std::pair<iterator, bool> {
+    auto const [parent, left] = find_slot(key);
+    if (parent == nullptr) { return { lower_bound(key), false }; }
+    auto * fresh = new node(std::piecewise_construct,
+                            std::forward_as_tuple(std::forward<K>(key)),
+                            std::forward_as_tuple(std::forward<Args>(args) ...));
+    attach(fresh, parent, left);
+    return { iterator(fresh), true };
+  }
+
+  auto insert(value_type const & value) -> std::pair<iterator, bool> { return emplace(value); }
+  auto insert(value_type && value) -> std::pair<iterator, bool> { return emplace(std::move(value)); }
+
+  template <std::input_iterator It>
+  auto insert(It first, It last) -> void {
+    for (; first != last; ++first) { emplace(*first); }
+  }
+
+  auto insert(std::initializer_list<value_type> init) -> void {
+    insert(init.begin(), init.end());
+  }
+
+  auto insert(node_type && nh) -> insert_return_type {
+    if (nh.empty()) { return { end(), false, {} }; }
+    auto const [parent, left] = find_slot(nh.key());
+    if (parent == nullptr) {
+      auto pos = find(nh.key());
+      return { pos, false, std::move(nh) };
+    }
+    auto * nd = nh.release();
+    reset_links(nd);
+    attach(nd, parent, left);
+    return { iterator(nd), true, {} };
+  }
+
+  auto insert(const_iterator, node_type && nh) -> iterator {
+    return insert(std::move(nh)).position;
+  }
+
+  template <class M>
+  auto insert_or_assign(key_type const & key, M && obj) -> std::pair<iterator, bool> {
+    auto result = try_emplace(key, std::forward<M>(obj));
+    if (!result.second) {
+      as_node(result.first.cur_)->value.second = std::forward<M>(obj);
+      refresh(result.first);
+    }
+    return result;
+  }
+
+  auto operator[](key_type const & key) -> mapped_type & requires (!augmented) {
+    return try_emplace(key).first->second;
+  }
+  auto operator[](key_type && key) -> mapped_type & requires (!augmented) {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  auto extract(const_iterator pos) -> node_type {
+    auto * nd = as_node(pos.cur_);
+    detach(nd);
+    return node_type(nd);
+  }
+
+  auto extract(key_type const & key) -> node_type {
+    auto pos = find(key);
+    return pos == end() ? node_type() : extract(pos);
+  }
+
+  auto erase(const_iterator pos) -> iterator {
+    auto next = iterator(successor(pos.cur_));
+    auto * nd = as_node(pos.cur_);
+    detach(nd);
+    delete nd;
+    return next;
+  }
+  auto erase(iterator pos) -> iterator requires (!augmented) {
+    return erase(const_iterator(pos));
+  }
+
+  auto erase(const_iterator first, const_iterator last) -> iterator {
+    while (first != last) { first = erase(first); }
+    return iterator(last.cur_);
+  }
+
+  auto erase(key_type const & key) -> size_type {
+    auto pos = find(key);
+    if (pos == end()) { return 0; }
+    erase(pos);
+    return 1;
+  }
+
+  // move every element of source whose key is absent here; the rest stay
+  auto merge(order_statistic_map & source) -> void {
+    for (auto it = source.begin(); it != source.end(); ) {
+      auto const [parent, left] = find_slot(it->first);
+      if (parent == nullptr) { ++it; continue; }
+      auto * nd = as_node(it.cur_);
+      ++it;
+      source.detach(nd);
+      reset_links(nd);
+      attach(nd, parent, left);
+    }
+  }
+
+  auto merge(order_statistic_map && source) -> void { merge(source); }
+
+  auto clear() noexcept -> void {
+    destroy(root());
+    set_root(nullptr);
+  }
+
+  auto swap(order_statistic_map & other) noexcept -> void {
+    auto * mine = root();
+    set_root(other.root());
+    other.set_root(mine);
+    std::swap(comp_, other.comp_);
+  }
+
+  friend auto swap(order_statistic_map & lhs, order_statistic_map & rhs) noexcept -> void {
+    lhs.swap(rhs);
+  }
+
+  friend auto operator==(order_statistic_map const & lhs, order_statistic_map const & rhs)
+  -> bool {
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+
+  friend auto operator<=>(order_statistic_map const & lhs, order_statistic_map const & rhs) {
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(),
+                                                  rhs.begin(), rhs.end());
+  }
+
+  //  MARK: aggregates
+  // fold of every element
+  auto aggregate() const -> aggregate_type { return agg_of(root()); }
+
+  // fold of the elements with lo <= key < hi, in key order
+  auto aggregate(key_type const & lo, key_type const & hi) const -> aggregate_type {
+    auto const * cur = root();
+    // descend to the first node inside the range: the paths to lo and hi
+    //  part there
+    while (cur) {
+      if (comp_(key_of(cur), lo))       { cur = cur->right; }
+      else if (!comp_(key_of(cur), hi)) { cur = cur->left; }
+      else { break; }
+    }
+    if (cur == nullptr) { return Monoid::identity(); }
+
+    auto low = Monoid::identity();    // elements >= lo in the left subtree
+    for (auto const * nb = cur->left; nb; ) {
+      if (!comp_(key_of(nb), lo)) {
+        low = Monoid::combine(Monoid::combine(lift(nb), agg_of(nb->right)), low);
+        nb = nb->left;
+      }
+      else {
+        nb = nb->right;
+      }
+    }
+
+    auto high = Monoid::identity();   // elements < hi in the right subtree
+    for (auto const * nb = cur->right; nb; ) {
+      if (comp_(key_of(nb), hi)) {
+        high = Monoid::combine(high, Monoid::combine(agg_of(nb->left), lift(nb)));
+        nb = nb->right;
+      }
+      else {
+        nb = nb->left;
+      }
+    }
+
+    return Monoid::combine(Monoid::combine(low, lift(cur)), high);
+  }
+
+  /*
+   *  Apply fn(mapped_type &) to the element at pos / key and repair the
+   *  aggregates above it.  update(key, fn) returns false if key is absent.
+   */
+  template <class Fn>
+  auto update(const_iterator pos, Fn && fn) -> void {
+    std::invoke(std::forward<Fn>(fn), as_node(pos.cur_)->value.second);
+    refresh(pos);
+  }
+
+  template <class Fn>
+  auto update(key_type const & key, Fn && fn) -> bool {
+    auto pos = find(key);
+    if (pos == end()) { return false; }
+    update(const_iterator(pos), std::forward<Fn>(fn));
+    return true;
+  }
+
+  // writable view of one mapped value; aggregates are repaired when it dies
+  class mapped_handle {
+  public:
+    mapped_handle(order_statistic_map & owner, const_iterator pos)
+      : owner_(&owner), pos_(pos) {}
+    mapped_handle(mapped_handle const &) = delete;
+    auto operator=(mapped_handle const &) -> mapped_handle & = delete;
+    ~mapped_handle() { owner_->refresh(pos_); }
+
+    auto operator*() const -> mapped_type & { return as_node(pos_.cur_)->value.second; }
+    auto operator->() const -> mapped_type * { return &**this; }
+
+  private:
+    order_statistic_map * owner_;
+    const_iterator        pos_;
+  };
+
+  auto modify(const_iterator pos) -> mapped_handle { return mapped_handle(*this, pos); }
+
+  // recompute aggregates from pos to the root after an in-place change
+  auto refresh(const_iterator pos) -> void {
+    for (auto * nb = const_cast<node_base *>(pos.cur_); nb != &header_; nb = nb->parent) {
+      update(nb);
+    }
+  }
+
+  // AVL balance, parent links, subtree sizes, aggregates and key order all hold
+  [[nodiscard]] auto validate() const -> bool {
+    return root() == nullptr
+        || (root()->parent == &header_ && check(root()).first);
+  }
+
+private:
+  auto root() const -> node_base * { return header_.left; }
+  auto set_root(node_base * nb) -> void {
+    header_.left = nb;
+    if (nb) { nb->parent = &header_; }
+  }
+
+  auto leftmost() const -> node_base const * {
+    auto const * cur = root();
+    if (cur == nullptr) { return &header_; }
+    while (cur->left) { cur = cur->left; }
+    return cur;
+  }
+
+  // the header is the parent of the root and the end() position
+  static auto successor(node_base const * cur) -> node_base const * {
+    if (cur->right) {
+      cur = cur->right;
+      while (cur->left) { cur = cur->left; }
+      return cur;
+    }
+    while (cur->parent->right == cur) { cur = cur->parent; }
+    return cur->parent;
+  }
+
+  static auto predecessor(node_base const * cur) -> node_base const * {
+    if (cur->left) {
+      cur = cur->left;
+      while (cur->right) { cur = cur->right; }
+      return cur;
+    }
+    while (cur->parent->left == cur) { cur = cur->parent; }
+    return cur->parent;
+  }
+
+  auto select(size_type index) const -> node_base const * {
+    if (index >= size()) { return &header_; }
+    auto const * cur = root();
+    for (;;) {
+      auto const lsize = size_of(cur->left);
+      if (index < lsize)       { cur = cur->left; }
+      else if (index == lsize) { return cur; }
+      else                     { index -= lsize + 1; cur = cur->right; }
+    }
+  }
+
+  // where key would be linked, or {nullptr, _} when already present
+  auto find_slot(key_type const & key) -> std::pair<node_base *, bool> {
+    node_base * parent = &header_;
+    auto * cur = root();
+    auto left = true;
+    node_base * candidate = nullptr;   // last node with !(node < key)
+    while (cur) {
+      parent = cur;
+      left = comp_(key, key_of(cur));
+      if (!left) { candidate = cur; }
+      cur = left ? cur->left : cur->right;
+    }
+    if (candidate && !comp_(key_of(candidate), key)) { return { nullptr, false }; }
+    return { parent, left };
+  }
+
+  static auto reset_links(node_base * nb) -> void {
+    nb->parent = nb->left = nb->right = nullptr;
+    update(nb);   // key or mapped value may have changed while detached
+  }
+
+  //  MARK: rebalancing
+  static auto update(node_base * nb) -> void {
+    nb->size = size_of(nb->left) + size_of(nb->right) + 1;
+    nb->height = static_cast<std::int8_t>(
+      std::max(height_of(nb->left), height_of(nb->right)) + 1);
+    if constexpr (augmented) {
+      nb->agg = Monoid::combine(Monoid::combine(agg_of(nb->left), lift(nb)),
+                                agg_of(nb->right));
+    }
+  }
+
+  static auto replace_child(node_base * parent, node_base * old, node_base * fresh) -> void {
+    if (parent->left == old) { parent->left = fresh; }
+    else                     { parent->right = fresh; }
+    if (fresh) { fresh->parent = parent; }
+  }
+
+  static auto rotate_left(node_base * top) -> node_base * {
+    auto * pivot = top->right;
+    replace_child(top->parent, top, pivot);
+    top->right = pivot->left;
+    if (top->right) { top->right->parent = top; }
+    pivot->left = top;
+    top->parent = pivot;
+    update(top);
+    update(pivot);
+    return pivot;
+  }
+
+  static auto rotate_right(node_base * top) -> node_base * {
+    auto * pivot = top->left;
+    replace_child(top->parent, top, pivot);
+    top->left = pivot->right;
+    if (top->left) { top->left->parent = top; }
+    pivot->right = top;
+    top->parent = pivot;
+    update(top);
+    update(pivot);
+    return pivot;
+  }
+
+  static auto balance(node_base * nb) -> node_base * {
+    update(nb);
+    auto const skew = height_of(nb->left) - height_of(nb->right);
+    if (skew > 1) {
+      if (height_of(nb->left->left) < height_of(nb->left->right)) { rotate_left(nb->left); }
+      return rotate_right(nb);
+    }
+    if (skew < -1) {
+      if (height_of(nb->right->right) < height_of(nb->right->left)) { rotate_right(nb->right); }
+      return rotate_left(nb);
+    }
+    return nb;
+  }
+
+  // sizes change all the way up, so always walk to the root
+  auto rebalance_from(node_base * nb) -> void {
+    while (nb != &header_) {
+      nb = balance(nb)->parent;
+    }
+  }
+
+  auto attach(node_base * fresh, node_base * parent, bool left) -> void {
+    fresh->parent = parent;
+    if (parent == &header_) { header_.left = fresh; return; }
+    (left ? parent->left : parent->right) = fresh;
+    rebalance_from(parent);
+  }
+
+  auto detach(node_base * nb) -> void {
+    node_base * start = nullptr;
+    if (nb->left && nb->right) {
+      // splice the in-order successor into nb's place
+      auto * heir = nb->right;
+      while (heir->left) { heir = heir->left; }
+      if (heir->parent == nb) {
+        start = heir;
+      }
+      else {
+        start = heir->parent;
+        replace_child(heir->parent, heir, heir->right);
+        heir->right = nb->right;
+        heir->right->parent = heir;
+      }
+      replace_child(nb->parent, nb, heir);
+      heir->left = nb->left;
+      heir->left->parent = heir;
+    }
+    else {
+      start = nb->parent;
+      replace_child(nb->parent, nb, nb->left ? nb->left : nb->right);
+    }
+    rebalance_from(start);
+  }
+
+  static auto clone(node_base const * src, node_base * parent) -> node_base * {
+    if (src == nullptr) { return nullptr; }
+    auto * copy = new node(as_node(src)->value);
+    copy->parent = parent;
+    copy->size = src->size;
+    copy->height = src->height;
+    copy->agg = src->agg;
+    copy->left = clone(src->left, copy);
+    copy->right = clone(src->right, copy);
+    return copy;
+  }
+
+  static auto destroy(node_base * nb) -> void {
+    while (nb) {
+      destroy(nb->right);
+      auto * left = nb->left;
+      delete as_node(nb);
+      nb = left;
+    }
+  }
+
+  // {ok, height}
+  auto check(node_base const * nb) const -> std::pair<bool, int> {
+    if (nb == nullptr) { return { true, 0 }; }
+    auto const [lok, lh] = check(nb->left);
+    auto const [rok, rh] = check(nb->right);
+    auto ok = lok && rok
+           && std::abs(lh - rh) <= 1
+           && nb->height == std::max(lh, rh) + 1
+           && nb->size == size_of(nb->left) + size_of(nb->right) + 1
+           && nb->agg == Monoid::combine(Monoid::combine(agg_of(nb->left), lift(nb)),
+                                         agg_of(nb->right))
+           && (!nb->left  || (nb->left->parent == nb  && comp_(key_of(nb->left), key_of(nb))))
+           && (!nb->right || (nb->right->parent == nb && comp_(key_of(nb), key_of(nb->right))));
+    return { ok, std::max(lh, rh) + 1 };
+  }
+
+  node_base header_;
+  [[no_unique_address]] Compare comp_;
+};
+
+template <class Key, class T, class Monoid, class Compare = std::less<Key>>
+using augmented_map = order_statistic_map<Key, T, Compare, Monoid>;
+
+} /* namespace cmapos */
+
+#endif /* order_statistic_map_hpp */
@@ -0,0 +1,581 @@
+//
+//  persistent_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: Driscoll et al., "Making Data Structures Persistent"
+//  @see: Okasaki, "Purely Functional Data Structures"
+//  @see: https://clojure.org/reference/transients
+//
+
+#ifndef persistent_map_hpp
+#define persistent_map_hpp
+
+#include <atomic>
+#include <array>
+#include <utility>
+#include <tuple>
+#include <functional>
+#include <iterator>
+#include <initializer_list>
+#include <stdexcept>
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdlib>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmappm
+namespace cmappm {
+
+/*
+ *  MARK: persistent_map
+ *  Ordered map whose copies share structure.  Nodes of an AVL tree are
+ *  reference counted and never changed while more than one tree can
+ *  reach them, so:
+ *    - copying a map (a snapshot) is O(1): one count is bumped;
+ *    - an update copies only the nodes on its root-to-leaf path that
+ *      are still shared, O(log n), and leaves every snapshot untouched;
+ *    - a node reachable from one map only is updated in place, so a
+ *      map with no outstanding snapshots allocates no more than std::map.
+ *  Counts are atomic: a snapshot may be handed to, read by and released
+ *  on another thread while the writer keeps editing its own map.  A
+ *  single map object is no more thread-safe than std::map.
+ *
+ *  Elements are read-only through a persistent_map; change them with
+ *  insert_or_assign() / update(), or in bulk through a transient.
+ *  Iterators are invalidated by any update of the map they came from,
+ *  but never by updates of another map sharing its nodes.
+ */
+template <class Key, class T, class Compare = std::less<Key>>
+class persistent_map {
+public:
+  using key_type    = Key;
+  using mapped_type = T;
+  using value_type  = std::pair<Key const, T>;
+  using size_type   = std::size_t;
+  using key_compare = Compare;
+
+  class transient;
+
+private:
+  struct node;
+
+  //  MARK: node_ptr
+  class node_ptr {
+  public:
+    node_ptr() = default;
+    explicit node_ptr(node * ptr) noexcept : ptr_(ptr) {}
+    node_ptr(node_ptr const & other) noexcept : ptr_(other.ptr_) { retain(ptr_); }
+    node_ptr(node_ptr && other) noexcept : ptr_(std::exchange(other.ptr_, nullptr)) {}
+    auto operator=(node_ptr const & other) noexcept -> node_ptr & {
+      retain(other.ptr_);
+      release(std::exchange(ptr_, other.ptr_));
+      return *this;
+    }
+    auto operator=(node_ptr && other) noexcept -> node_ptr & {
+      release(std::exchange(ptr_, std::exchange(other.ptr_, nullptr)));
+      return *this;
+    }
+    ~node_ptr() { release(ptr_); }
+
+    auto get() const noexcept -> node * { return ptr_; }
+    auto operator->() const noexcept -> node * { return ptr_; }
+    explicit operator bool() const noexcept { return ptr_ != nullptr; }
+    auto unique() const noexcept -> bool {
+      return ptr_->refs.load(std::memory_order_acquire) == 1;
+    }
+
+  private:
+    static auto retain(node * ptr) noexcept -> void {
+      if (ptr) { ptr->refs.fetch_add(1, std::memory_order_relaxed); }
+    }
+    static auto release(node * ptr) noexcept -> void {
+      if (ptr && ptr->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) { delete ptr; }
+    }
+
+    node * ptr_ = nullptr;
+  };
+
+  struct node {
+    template <class ... Args>
+      requires std::constructible_from<value_type, Args ...>
+    explicit node(Args && ... args) : value(std::forward<Args>(args) ...) {}
+    node(node const & other)
+      : value(other.value), left(other.left), right(other.right), height(other.height) {}
+
+    value_type               value;
+    node_ptr                 left;
+    node_ptr                 right;
+    int                      height = 1;
+    std::atomic<std::size_t> refs { 1 };
+  };
+
+public:
+  //  MARK: const_iterator
+  // AVL height is below 1.45 log2(n + 2); 64 levels outgrow any memory
+  static constexpr std::size_t max_depth = 64;
+
+  class const_iterator {
+    friend class persistent_map;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = persistent_map::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = value_type const *;
+    using reference         = value_type const &;
+
+    const_iterator() = default;
+
+    auto operator*() const -> reference { return top()->value; }
+    auto operator->() const -> pointer { return &top()->value; }
+
+    auto operator++() -> const_iterator & {
+      if (auto const * cur = top(); cur->right) {
+        descend(cur->right.get(), &node::left);
+      }
+      else {
+        climb(&node::right);
+      }
+      return *this;
+    }
+    auto operator++(int) -> const_iterator { auto tmp = *this; ++*this; return tmp; }
+
+    auto operator--() -> const_iterator & {
+      if (depth_ == 0) {
+        descend(root_, &node::right);
+      }
+      else if (auto const * cur = top(); cur->left) {
+        descend(cur->left.get(), &node::right);
+      }
+      else {
+        climb(&node::left);
+      }
+      return *this;
+    }
+    auto operator--(int) -> const_iterator { auto tmp = *this; --*this; return tmp; }
+
+    friend bool operator==(const_iterator const & lhs, const_iterator const & rhs) {
+      return lhs.depth_ == rhs.depth_ && (lhs.depth_ == 0 || lhs.top() == rhs.top());
+    }
+
+  private:
+    explicit const_iterator(node const * root) : root_(root) {}
+
+    auto top() const -> node const * { return path_[depth_ - 1]; }
+
+    // push nd, then follow side links to the extreme
+    auto descend(node const * nd, node_ptr node::* side) -> void {
+      for (; nd; nd = (nd->*side).get()) { path_[depth_++] = nd; }
+    }
+
+    // pop while the popped node was the parent's child on that side
+    auto climb(node_ptr node::* side) -> void {
+      node const * child = nullptr;
+      do { child = path_[--depth_]; }
+      while (depth_ > 0 && (top()->*side).get() == child);
+    }
+
+    std::array<node const *, max_depth> path_ {};
+    std::size_t  depth_ = 0;   // 0: end()
+    node const * root_  = nullptr;
+  };
+
+  using iterator               = const_iterator;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reverse_iterator       = const_reverse_iterator;
+
+  //  MARK: construction
+  persistent_map() = default;
+  explicit persistent_map(Compare const & comp) : comp_(comp) {}
+
+  persistent_map(std::initializer_list<value_type> init, Compare const & comp = Compare())
+    : comp_(comp) {
+    insert(init.begin(), init.end());
+  }
+
+  template <std::input_iterator It>
+  persistent_map(It first, It last, Compare const & comp = Compare()) : comp_(comp) {
+    insert(first, last);
+  }
+
+  // copies and assignments share the tree: O(1)
+  persistent_map(persistent_map const &) = default;
+  // a moved-from map is empty: the size goes with the tree
+  persistent_map(persistent_map && other) noexcept
+    : root_(std::move(other.root_)), size_(std::exchange(other.size_, 0)), comp_(other.comp_) {}
+  auto operator=(persistent_map const &) -> persistent_map & = default;
+  auto operator=(persistent_map && other) noexcept -> persistent_map & {
+    if (this != &other) {
+      root_ = std::move(other.root_);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+  ~persistent_map() = default;
+
+  auto snapshot() const -> persistent_map { return *this; }
+
+  //  MARK: iterators
+  auto begin() const -> const_iterator {
+    auto it = const_iterator(root_.get());
+    it.descend(root_.get(), &node::left);
+    return it;
+  }
+  auto end() const -> const_iterator { return const_iterator(root_.get()); }
+  auto cbegin() const -> const_iterator { return begin(); }
+  auto cend() const -> const_iterator { return end(); }
+  auto rbegin() const { return const_reverse_iterator(end()); }
+  auto rend() const { return const_reverse_iterator(begin()); }
+  auto crbegin() const { return rbegin(); }
+  auto crend() const { return rend(); }
+
+  //  MARK: capacity
+  [[nodiscard]] auto empty() const noexcept -> bool { return size_ == 0; }
+  auto size() const noexcept -> size_type { return size_; }
+  auto key_comp() const -> key_compare { return comp_; }
+
+  // true when both maps are the same version: O(1)
+  auto shares_root_with(persistent_map const & other) const noexcept -> bool {
+    return root_.get() == other.root_.get();
+  }
+
+  //  MARK: lookup
+  auto lower_bound(Key const & key) const -> const_iterator {
+    auto it = const_iterator(root_.get());
+    std::size_t keep = 0;
+    for (node const * nd = root_.get(); nd; ) {
+      it.path_[it.depth_++] = nd;
+      if (!comp_(nd->value.first, key)) { keep = it.depth_; nd = nd->left.get(); }
+      else                              { nd = nd->right.get(); }
+    }
+    it.depth_ = keep;
+    return it;
+  }
+
+  auto upper_bound(Key const & key) const -> const_iterator {
+    auto it = const_iterator(root_.get());
+    std::size_t keep = 0;
+    for (node const * nd = root_.get(); nd; ) {
+      it.path_[it.depth_++] = nd;
+      if (comp_(key, nd->value.first)) { keep = it.depth_; nd = nd->left.get(); }
+      else                             { nd = nd->right.get(); }
+    }
+    it.depth_ = keep;
+    return it;
+  }
+
+  auto find(Key const & key) const -> const_iterator {
+    auto it = lower_bound(key);
+    return it != end() && !comp_(key, it->first) ? it : end();
+  }
+
+  auto equal_range(Key const & key) const { return std::pair(lower_bound(key), upper_bound(key)); }
+  auto contains(Key const & key) const -> bool { return lookup(key) != nullptr; }
+  auto count(Key const & key) const -> size_type { return contains(key) ? 1 : 0; }
+
+  auto at(Key const & key) const -> T const & {
+    auto const * nd = lookup(key);
+    if (!nd) { throw std::out_of_range("cmappm::persistent_map::at"); }
+    return nd->value.second;
+  }
+
+  //  MARK: modifiers
+  template <class ... Args>
+  auto try_emplace(Key const & key, Args && ... args) -> std::pair<const_iterator, bool> {
+    if (lookup(key)) { return { find(key), false }; }
+    place(key, [&] {
+      return new node(std::piecewise_construct, std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args) ...));
+    });
+    return { find(key), true };
+  }
+
+  auto insert(value_type const & value) -> std::pair<const_iterator, bool> {
+    return try_emplace(value.first, value.second);
+  }
+
+  template <std::input_iterator It>
+  auto insert(It first, It last) -> void {
+    for (; first != last; ++first) { try_emplace(first->first, first->second); }
+  }
+
+  template <class M>
+  auto insert_or_assign(Key const & key, M && obj) -> std::pair<const_iterator, bool> {
+    auto const [nd, inserted] = place(key, [&] { return new node(key, std::forward<M>(obj)); });
+    if (!inserted) { nd->value.second = std::forward<M>(obj); }
+    return { find(key), inserted };
+  }
+
+  /*
+   *  Apply fn(mapped_type &) to the value at key, copying the shared part
+   *  of its path first.  Returns false (and copies nothing) when key is
+   *  absent.
+   */
+  template <class Fn>
+  auto update(Key const & key, Fn && fn) -> bool {
+    if (!lookup(key)) { return false; }
+    auto const nd = place(key, [] { return static_cast<node *>(nullptr); }).first;
+    std::invoke(std::forward<Fn>(fn), nd->value.second);
+    return true;
+  }
+
+  auto erase(Key const & key) -> size_type {
+    if (!lookup(key)) { return 0; }
+    erase_at(root_, key);
+    --size_;
+    return 1;
+  }
+
+  auto clear() noexcept -> void {
+    root_ = node_ptr();
+    size_ = 0;
+  }
+
+  auto swap(persistent_map & other) noexcept -> void {
+    std::swap(root_, other.root_);
+    std::swap(size_, other.size_);
+    std::swap(comp_, other.comp_);
+  }
+
+  friend auto swap(persistent_map & lhs, persistent_map & rhs) noexcept -> void {
+    lhs.swap(rhs);
+  }
+
+  //  MARK: functional updates
+  template <class M>
+  auto with(Key const & key, M && obj) const -> persistent_map {
+    auto next = *this;
+    next.insert_or_assign(key, std::forward<M>(obj));
+    return next;
+  }
+
+  auto without(Key const & key) const -> persistent_map {
+    auto next = *this;
+    next.erase(key);
+    return next;
+  }
+
+  //  MARK: batch edits
+  auto as_transient() const & -> transient { return transient(*this); }
+  auto as_transient() && -> transient { return transient(std::move(*this)); }
+
+  // run fn(transient &) and publish the result as this map's next version
+  template <class Fn>
+  auto batch(Fn && fn) -> void {
+    auto tx = std::move(*this).as_transient();
+    std::invoke(std::forward<Fn>(fn), tx);
+    *this = std::move(tx).persistent();
+  }
+
+  //  MARK: comparison
+  friend auto operator==(persistent_map const & lhs, persistent_map const & rhs) -> bool {
+    if (lhs.size() != rhs.size()) { return false; }
+    if (lhs.shares_root_with(rhs)) { return true; }
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+
+  // debug check: AVL balance, heights and key order
+  auto validate() const -> bool {
+    size_type count = 0;
+    node const * prev = nullptr;
+    auto walk = [&](auto const & self, node const * nd) -> int {
+      if (!nd) { return 0; }
+      auto const lh = self(self, nd->left.get());
+      if (lh < 0) { return -1; }
+      if (prev && !comp_(prev->value.first, nd->value.first)) { return -1; }
+      prev = nd;
+      ++count;
+      auto const rh = self(self, nd->right.get());
+      if (rh < 0 || std::abs(lh - rh) > 1 || nd->height != 1 + std::max(lh, rh)) { return -1; }
+      return nd->height;
+    };
+    return walk(walk, root_.get()) >= 0 && count == size_;
+  }
+
+private:
+  auto lookup(Key const & key) const -> node * {
+    for (node * nd = root_.get(); nd; ) {
+      if      (comp_(key, nd->value.first)) { nd = nd->left.get(); }
+      else if (comp_(nd->value.first, key)) { nd = nd->right.get(); }
+      else                                  { return nd; }
+    }
+    return nullptr;
+  }
+
+  //  MARK: path copying
+  // make *slot safe to change: keep it if only this path reaches it,
+  //  otherwise swap in a private copy (sharing its children)
+  static auto own(node_ptr & slot) -> node * {
+    if (!slot.unique()) { slot = node_ptr(new node(*slot.get())); }
+    return slot.get();
+  }
+
+  static auto height(node_ptr const & ptr) -> int { return ptr ? ptr->height : 0; }
+  static auto fix(node * nd) -> void {
+    nd->height = 1 + std::max(height(nd->left), height(nd->right));
+  }
+
+  static auto rotate_right(node_ptr & slot) -> void {
+    own(slot->left);
+    auto pivot = std::move(slot->left);
+    slot->left = std::move(pivot->right);
+    fix(slot.get());
+    pivot->right = std::move(slot);
+    fix(pivot.get());
+    slot = std::move(pivot);
+  }
+
+  static auto rotate_left(node_ptr & slot) -> void {
+    own(slot->right);
+    auto pivot = std::move(slot->right);
+    slot->right = std::move(pivot->left);
+    fix(slot.get());
+    pivot->left = std::move(slot);
+    fix(pivot.get());
+    slot = std::move(pivot);
+  }
+
+  // slot is owned; restore the AVL invariant at it
+  static auto rebalance(node_ptr & slot) -> void {
+    auto * nd = slot.get();
+    auto const balance = height(nd->left) - height(nd->right);
+    if (balance > 1) {
+      auto * lhs = own(nd->left);
+      if (height(lhs->left) < height(lhs->right)) { rotate_left(nd->left); }
+      rotate_right(slot);
+    }
+    else if (balance < -1) {
+      auto * rhs = own(nd->right);
+      if (height(rhs->right) < height(rhs->left)) { rotate_right(nd->right); }
+      rotate_left(slot);
+    }
+    else {
+      fix(nd);
+    }
+  }
+
+  // owned node holding key, created with make() when absent
+  template <class Make>
+  auto place(Key const & key, Make && make) -> std::pair<node *, bool> {
+    auto inserted = false;
+    auto * nd = place_at(root_, key, make, inserted);
+    size_ += inserted;
+    return { nd, inserted };
+  }
+
+  template <class Make>
+  auto place_at(node_ptr & slot, Key const & key, Make & make, bool & inserted) -> node * {
+    if (!slot) {
+      slot = node_ptr(make());
+      inserted = true;
+      return slot.get();
+    }
+    auto * nd = own(slot);
+    node * hit = nullptr;
+    if      (comp_(key, nd->value.first)) { hit = place_at(nd->left, key, make, inserted); }
+    else if (comp_(nd->value.first, key)) { hit = place_at(nd->right, key, make, inserted); }
+    else                                  { return nd; }
+    if (inserted) { rebalance(slot); }
+    return hit;
+  }
+
+  // detach the owned minimum of a non-empty subtree
+  static auto take_min(node_ptr & slot) -> node_ptr {
+    auto * nd = own(slot);
+    if (!nd->left) {
+      auto least = std::move(slot);
+      slot = std::move(least->right);
+      return least;
+    }
+    auto least = take_min(nd->left);
+    rebalance(slot);
+    return least;
+  }
+
+  // key is known to be present
+  auto erase_at(node_ptr & slot, Key const & key) -> void {
+    auto * nd = own(slot);
+    if      (comp_(key, nd->value.first)) { erase_at(nd->left, key); }
+    else if (comp_(nd->value.first, key)) { erase_at(nd->right, key); }
+    else if (!nd->left)                   { slot = std::move(nd->right); return; }
+    else if (!nd->right)                  { slot = std::move(nd->left); return; }
+    else {
+      auto heir = take_min(nd->right);
+      heir->left = std::move(nd->left);
+      heir->right = std::move(nd->right);
+      slot = std::move(heir);
+    }
+    rebalance(slot);
+  }
+
+  node_ptr  root_;
+  size_type size_ = 0;
+  [[no_unique_address]] Compare comp_;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: persistent_map::transient
+ *  Move-only working copy for bulk edits.  Its first change to a region
+ *  of the tree copies the shared path; later changes there are in place,
+ *  so n edits cost O(min(n log n, size)) allocations, not O(n log n).
+ *  Because it cannot be copied, no snapshot can observe a mapped value
+ *  through the references operator[] and at() hand out; persistent()
+ *  ends the batch and returns the new version.
+ */
+template <class Key, class T, class Compare>
+class persistent_map<Key, T, Compare>::transient {
+public:
+  explicit transient(persistent_map base) : map_(std::move(base)) {}
+  transient(transient &&) noexcept = default;
+  auto operator=(transient &&) noexcept -> transient & = default;
+  transient(transient const &) = delete;
+  auto operator=(transient const &) -> transient & = delete;
+
+  [[nodiscard]] auto empty() const noexcept -> bool { return map_.empty(); }
+  auto size() const noexcept -> size_type { return map_.size(); }
+  auto contains(Key const & key) const -> bool { return map_.contains(key); }
+  auto find(Key const & key) const -> const_iterator { return map_.find(key); }
+  auto begin() const -> const_iterator { return map_.begin(); }
+  auto end() const -> const_iterator { return map_.end(); }
+
+  auto at(Key const & key) -> T & {
+    if (!map_.lookup(key)) { throw std::out_of_range("cmappm::persistent_map::transient::at"); }
+    return map_.place(key, [] { return static_cast<node *>(nullptr); }).first->value.second;
+  }
+
+  auto operator[](Key const & key) -> T & requires std::default_initializable<T> {
+    return map_.place(key, [&key] {
+      return new node(std::piecewise_construct, std::forward_as_tuple(key), std::tuple<>());
+    }).first->value.second;
+  }
+
+  template <class ... Args>
+  auto try_emplace(Key const & key, Args && ... args) -> bool {
+    return map_.try_emplace(key, std::forward<Args>(args) ...).second;
+  }
+
+  template <class M>
+  auto insert_or_assign(Key const & key, M && obj) -> bool {
+    return map_.insert_or_assign(key, std::forward<M>(obj)).second;
+  }
+
+  template <class Fn>
+  auto update(Key const & key, Fn && fn) -> bool {
+    return map_.update(key, std::forward<Fn>(fn));
+  }
+
+  auto erase(Key const & key) -> size_type { return map_.erase(key); }
+
+  auto persistent() && -> persistent_map { return std::move(map_); }
+
+private:
+  persistent_map map_;
+};
+
+} /* namespace cmappm */
+
+#endif /* persistent_map_hpp */
@@ -0,0 +1,241 @@
+//
+//  rcu_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: McKenney & Walpole, "What is RCU, Fundamentally?"
+//  @see: Fraser, "Practical lock-freedom" (epoch-based reclamation)
+//  @see: https://en.cppreference.com/w/cpp/atomic/memory_order
+//
+
+#ifndef rcu_map_hpp
+#define rcu_map_hpp
+
+#include <map>
+#include <array>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <functional>
+#include <initializer_list>
+#include <cstddef>
+#include <cstdint>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmaprcu
+namespace cmaprcu {
+
+// small per-thread number, handed out once per thread in arrival order
+inline
+auto thread_index() -> std::size_t {
+  static std::atomic<std::size_t> next { 0 };
+  thread_local auto const mine = next.fetch_add(1, std::memory_order_relaxed);
+  return mine;
+}
+
+/*
+ *  MARK: rcu_map
+ *  Read-mostly map.  Readers see an immutable Snapshot (std::map by
+ *  default; any map-like type with insert_or_assign() and erase() will
+ *  do) through a pinned pointer:
+ *    - entering a read is an epoch load, one fetch_add on a counter the
+ *      reader's thread shares with few or no others, and a pointer load;
+ *      leaving is one fetch_sub.  Readers never wait and never retry;
+ *    - writers stage insert_or_assign() / erase() calls and publish()
+ *      applies the whole batch to a private copy, then swaps it in with
+ *      one atomic exchange;
+ *    - replaced versions are retired, not deleted.  The writer advances
+ *      a global epoch only once no reader is left in the epoch before,
+ *      and frees a version two epochs after it was retired, by which
+ *      time every reader that could have loaded it has left.
+ *  Writers are serialised by a mutex and pay a full copy per publish:
+ *  batch updates rather than publishing each change.
+ */
+template <class Key, class T,
+          class Compare = std::less<Key>,
+          class Snapshot = std::map<Key, T, Compare>>
+class rcu_map {
+public:
+  using key_type      = Key;
+  using mapped_type   = T;
+  using snapshot_type = Snapshot;
+  using size_type     = std::size_t;
+
+  static constexpr size_type reader_slots = 64;
+
+private:
+  struct alignas(64) reader_slot {
+    std::array<std::atomic<std::size_t>, 2> active {};  // readers by epoch parity
+  };
+
+public:
+  //  MARK: read_guard
+  class read_guard {
+  public:
+    explicit read_guard(rcu_map const & owner)
+      : slot_(&owner.slots_[thread_index() % reader_slots]),
+        parity_(owner.epoch_.load() & 1) {
+      slot_->active[parity_].fetch_add(1);
+      snap_ = owner.current_.load();
+    }
+    read_guard(read_guard && other) noexcept
+      : slot_(std::exchange(other.slot_, nullptr)), parity_(other.parity_), snap_(other.snap_) {}
+    read_guard(read_guard const &) = delete;
+    auto operator=(read_guard const &) -> read_guard & = delete;
+    auto operator=(read_guard &&) -> read_guard & = delete;
+    ~read_guard() {
+      if (slot_) { slot_->active[parity_].fetch_sub(1, std::memory_order_release); }
+    }
+
+    auto get() const noexcept -> Snapshot const * { return snap_; }
+    auto operator*() const noexcept -> Snapshot const & { return *snap_; }
+    auto operator->() const noexcept -> Snapshot const * { return snap_; }
+
+  private:
+    reader_slot *    slot_;
+    std::size_t      parity_;
+    Snapshot const * snap_ = nullptr;
+  };
+
+  //  MARK: construction
+  rcu_map() : rcu_map(Snapshot {}) {}
+  explicit rcu_map(Snapshot initial) : current_(new Snapshot(std::move(initial))) {}
+  rcu_map(std::initializer_list<typename Snapshot::value_type> init)
+    : rcu_map(Snapshot(init)) {}
+
+  rcu_map(rcu_map const &) = delete;
+  auto operator=(rcu_map const &) -> rcu_map & = delete;
+
+  // no reader may still be pinned
+  ~rcu_map() {
+    delete current_.load();
+    for (auto & old : retired_) { delete old.snap; }
+  }
+
+  //  MARK: readers
+  auto pin() const -> read_guard { return read_guard(*this); }
+
+  template <class Fn>
+  auto read(Fn && fn) const -> decltype(auto) {
+    auto const guard = pin();
+    return std::invoke(std::forward<Fn>(fn), *guard);
+  }
+
+  auto get(Key const & key) const -> std::optional<T> {
+    auto const guard = pin();
+    if (auto it = guard->find(key); it != guard->end()) { return it->second; }
+    return std::nullopt;
+  }
+
+  auto contains(Key const & key) const -> bool { return pin()->contains(key); }
+  auto size() const -> size_type { return pin()->size(); }
+
+  //  MARK: writers
+  template <class M>
+  auto insert_or_assign(Key const & key, M && obj) -> void {
+    auto lock = std::scoped_lock(writer_mx_);
+    staged_.emplace_back(key, std::optional<T>(std::forward<M>(obj)));
+  }
+
+  auto erase(Key const & key) -> void {
+    auto lock = std::scoped_lock(writer_mx_);
+    staged_.emplace_back(key, std::nullopt);
+  }
+
+  auto pending() const -> size_type {
+    auto lock = std::scoped_lock(writer_mx_);
+    return staged_.size();
+  }
+
+  // apply the staged changes as one new version; false if none were staged
+  auto publish() -> bool {
+    auto lock = std::scoped_lock(writer_mx_);
+    if (staged_.empty()) { return false; }
+    install(edited_copy([](Snapshot &) {}));
+    return true;
+  }
+
+  // staged changes, then fn(Snapshot &), published as one new version
+  template <class Fn>
+  auto update(Fn && fn) -> void {
+    auto lock = std::scoped_lock(writer_mx_);
+    install(edited_copy(std::forward<Fn>(fn)));
+  }
+
+  // free every retired version no reader can still hold
+  auto reclaim() -> size_type {
+    auto lock = std::scoped_lock(writer_mx_);
+    return collect();
+  }
+
+  auto version() const noexcept -> std::uint64_t { return version_.load(std::memory_order_relaxed); }
+
+  auto retired() const -> size_type {
+    auto lock = std::scoped_lock(writer_mx_);
+    return retired_.size();
+  }
+
+private:
+  struct retired_version {
+    std::uint64_t    epoch;
+    Snapshot const * snap;
+  };
+
+  template <class Fn>
+  auto edited_copy(Fn && fn) -> std::unique_ptr<Snapshot> {
+    auto next = std::make_unique<Snapshot>(*current_.load());
+    for (auto & [key, value] : staged_) {
+      if (value) { next->insert_or_assign(key, std::move(*value)); }
+      else       { next->erase(key); }
+    }
+    staged_.clear();
+    std::invoke(std::forward<Fn>(fn), *next);
+    return next;
+  }
+
+  auto install(std::unique_ptr<Snapshot> next) -> void {
+    auto const * old = current_.exchange(next.release());
+    retired_.push_back({ epoch_.load(), old });
+    version_.fetch_add(1, std::memory_order_relaxed);
+    collect();
+  }
+
+  // epoch e -> e + 1 once no reader of epoch e - 1 (same parity) remains
+  auto try_advance() -> bool {
+    auto const epoch = epoch_.load();
+    for (auto const & slot : slots_) {
+      if (slot.active[(epoch + 1) & 1].load() != 0) { return false; }
+    }
+    epoch_.store(epoch + 1);
+    return true;
+  }
+
+  auto collect() -> size_type {
+    while (!retired_.empty() && retired_.back().epoch + 2 > epoch_.load() && try_advance()) {}
+    auto const epoch = epoch_.load();
+    size_type freed = 0;
+    while (freed < retired_.size() && retired_[freed].epoch + 2 <= epoch) {
+      delete retired_[freed].snap;
+      ++freed;
+    }
+    retired_.erase(retired_.begin(), retired_.begin() + static_cast<std::ptrdiff_t>(freed));
+    return freed;
+  }
+
+  std::atomic<Snapshot const *> current_;
+  std::atomic<std::uint64_t>    epoch_ { 0 };
+  std::atomic<std::uint64_t>    version_ { 0 };
+  mutable std::array<reader_slot, reader_slots> slots_ {};
+
+  mutable std::mutex writer_mx_;
+  std::vector<std::pair<Key, std::optional<T>>> staged_;
+  std::vector<retired_version> retired_;
+};
+
+} /* namespace cmaprcu */
+
+#endif /* rcu_map_hpp */
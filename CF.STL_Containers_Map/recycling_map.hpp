@@ -0,0 +1,285 @@
+//
+//  recycling_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/container/map/extract
+//  @see: https://en.cppreference.com/w/cpp/container/map/insert
+//  @see: https://en.cppreference.com/w/cpp/container/node_handle
+//
+
+#ifndef recycling_map_hpp
+#define recycling_map_hpp
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <tuple>
+#include <functional>
+#include <iterator>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <cstddef>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmaprec
+namespace cmaprec {
+
+/*
+ *  MARK: node_pool
+ *  Bounded cache of extracted node handles for one map type.  A pool
+ *  may belong to a single map or, through this_thread(), be shared by
+ *  every map of that type on the calling thread; node handles may move
+ *  between maps because std::allocator instances always compare equal.
+ *  Not thread-safe: share a pool only within one thread.
+ */
+template <class Map>
+class node_pool {
+public:
+  using node_type = typename Map::node_type;
+  using size_type = std::size_t;
+
+  static constexpr size_type default_capacity = 1'024;
+
+  explicit node_pool(size_type capacity = default_capacity) : capacity_(capacity) {}
+
+  node_pool(node_pool const &) = delete;
+  auto operator=(node_pool const &) -> node_pool & = delete;
+
+  static auto this_thread() -> node_pool & {
+    thread_local node_pool pool;
+    return pool;
+  }
+
+  // an empty handle when the pool is dry
+  auto take() -> node_type {
+    if (free_.empty()) { return {}; }
+    auto nh = std::move(free_.back());
+    free_.pop_back();
+    return nh;
+  }
+
+  // false (and the node is freed) when the pool is full
+  auto give(node_type && nh) -> bool {
+    if (nh.empty() || free_.size() >= capacity_) { return false; }
+    free_.push_back(std::move(nh));
+    return true;
+  }
+
+  auto size() const noexcept -> size_type { return free_.size(); }
+  auto capacity() const noexcept -> size_type { return capacity_; }
+
+  auto set_capacity(size_type capacity) -> void {
+    capacity_ = capacity;
+    if (free_.size() > capacity_) { free_.resize(capacity_); }
+  }
+
+  auto release() noexcept -> void { free_.clear(); }
+
+private:
+  std::vector<node_type> free_;
+  size_type              capacity_;
+};
+
+/*
+ *  MARK: recycle_stats
+ *  reused:    inserts that took a cached node instead of allocating
+ *  allocated: inserts that had to allocate
+ *  recycled:  erased nodes handed to the pool
+ *  dropped:   erased nodes freed because the pool was full
+ */
+struct recycle_stats {
+  std::size_t reused    = 0;
+  std::size_t allocated = 0;
+  std::size_t recycled  = 0;
+  std::size_t dropped   = 0;
+
+  auto reuse_rate() const noexcept -> double {
+    auto const inserts = reused + allocated;
+    return inserts == 0 ? 0.0 : static_cast<double>(reused) / static_cast<double>(inserts);
+  }
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: recycling_map
+ *  std::map whose erased nodes go to a node_pool and whose inserts take
+ *  them back, rewriting key and value in the detached handle (as
+ *  nh.key() = 4 does in the extract demo) before splicing it in with a
+ *  hint.  Under steady churn, erase one key / insert another, the map
+ *  stops calling the allocator.  Mapped values are assigned, not
+ *  rebuilt, so a std::string value can also keep its buffer.
+ *
+ *  By default every map owns its pool; pass node_pool::this_thread() (or
+ *  any longer-lived pool) to share cached nodes between maps.
+ */
+template <class Key, class T, class Compare = std::less<Key>>
+  requires std::is_move_assignable_v<Key> && std::is_move_assignable_v<T>
+class recycling_map {
+public:
+  using map_type       = std::map<Key, T, Compare>;
+  using pool_type      = node_pool<map_type>;
+  using key_type       = Key;
+  using mapped_type    = T;
+  using value_type     = typename map_type::value_type;
+  using size_type      = typename map_type::size_type;
+  using key_compare    = Compare;
+  using iterator       = typename map_type::iterator;
+  using const_iterator = typename map_type::const_iterator;
+
+  explicit recycling_map(size_type cache_capacity = pool_type::default_capacity)
+    : own_(std::make_unique<pool_type>(cache_capacity)), pool_(own_.get()) {}
+
+  explicit recycling_map(pool_type & shared) : pool_(&shared) {}
+
+  // duplicate keys keep the first value, as std::map does
+  recycling_map(std::initializer_list<value_type> init) : recycling_map() {
+    for (auto const & value : init) { try_emplace(value.first, value.second); }
+  }
+
+  // the pool goes with the elements; the moved-from map is left without
+  //  one, so it neither reuses nor caches nodes until assigned again
+  recycling_map(recycling_map && other) noexcept
+    : map_(std::move(other.map_)), own_(std::move(other.own_)),
+      pool_(std::exchange(other.pool_, nullptr)), stats_(std::exchange(other.stats_, {})) {}
+
+  auto operator=(recycling_map && other) noexcept -> recycling_map & {
+    if (this != &other) { recycling_map(std::move(other)).swap(*this); }
+    return *this;
+  }
+
+  // nodes of the dying map go back to a shared pool
+  ~recycling_map() {
+    if (!own_) { clear(); }
+  }
+
+  //  MARK: access
+  auto begin()        noexcept { return map_.begin(); }
+  auto end()          noexcept { return map_.end(); }
+  auto begin()  const noexcept { return map_.begin(); }
+  auto end()    const noexcept { return map_.end(); }
+  auto cbegin() const noexcept { return map_.cbegin(); }
+  auto cend()   const noexcept { return map_.cend(); }
+  auto rbegin() const noexcept { return map_.crbegin(); }
+  auto rend()   const noexcept { return map_.crend(); }
+
+  [[nodiscard]] auto empty() const noexcept { return map_.empty(); }
+  auto size() const noexcept { return map_.size(); }
+
+  auto find(Key const & key)              { return map_.find(key); }
+  auto find(Key const & key)        const { return map_.find(key); }
+  auto contains(Key const & key)    const { return map_.contains(key); }
+  auto count(Key const & key)       const { return map_.count(key); }
+  auto at(Key const & key)          -> T & { return map_.at(key); }
+  auto at(Key const & key)    const -> T const & { return map_.at(key); }
+  auto lower_bound(Key const & key) const { return map_.lower_bound(key); }
+  auto upper_bound(Key const & key) const { return map_.upper_bound(key); }
+  auto key_comp() const { return map_.key_comp(); }
+
+  auto base() const noexcept -> map_type const & { return map_; }
+  auto pool() const noexcept -> pool_type const & { return *pool_; }   // not on a moved-from map
+  auto stats() const noexcept -> recycle_stats const & { return stats_; }
+
+  //  MARK: modifiers
+  template <class ... Args>
+  auto try_emplace(Key const & key, Args && ... args) -> std::pair<iterator, bool> {
+    auto pos = map_.lower_bound(key);
+    if (pos != map_.end() && !map_.key_comp()(key, pos->first)) { return { pos, false }; }
+    return { place(pos, key, [&](T & mapped) {
+      mapped = T(std::forward<Args>(args) ...);
+    }, std::forward<Args>(args) ...), true };
+  }
+
+  template <class ... Args>
+  auto emplace(Key const & key, Args && ... args) -> std::pair<iterator, bool> {
+    return try_emplace(key, std::forward<Args>(args) ...);
+  }
+
+  auto insert(value_type const & value) -> std::pair<iterator, bool> {
+    return try_emplace(value.first, value.second);
+  }
+
+  template <class M>
+  auto insert_or_assign(Key const & key, M && obj) -> std::pair<iterator, bool> {
+    auto pos = map_.lower_bound(key);
+    if (pos != map_.end() && !map_.key_comp()(key, pos->first)) {
+      pos->second = std::forward<M>(obj);
+      return { pos, false };
+    }
+    return { place(pos, key, [&](T & mapped) {
+      mapped = std::forward<M>(obj);
+    }, std::forward<M>(obj)), true };
+  }
+
+  auto operator[](Key const & key) -> T & requires std::is_default_constructible_v<T> {
+    return try_emplace(key).first->second;
+  }
+
+  auto erase(Key const & key) -> size_type {
+    auto it = map_.find(key);
+    if (it == map_.end()) { return 0; }
+    erase(it);
+    return 1;
+  }
+
+  auto erase(const_iterator pos) -> iterator {
+    auto next = std::next(map_.erase(pos, pos));  // const_iterator -> iterator
+    recycle(map_.extract(pos));
+    return next;
+  }
+
+  // every node goes to the pool, as far as it has room
+  auto clear() -> void {
+    while (!map_.empty()) { recycle(map_.extract(map_.begin())); }
+  }
+
+  auto swap(recycling_map & other) noexcept -> void {
+    map_.swap(other.map_);
+    std::swap(own_, other.own_);
+    std::swap(pool_, other.pool_);
+    std::swap(stats_, other.stats_);
+  }
+
+  friend auto operator==(recycling_map const & lhs, recycling_map const & rhs) -> bool {
+    return lhs.map_ == rhs.map_;
+  }
+
+private:
+  // a cached node rewritten by assign(), else a fresh one built from args
+  template <class Assign, class ... Args>
+  auto place(const_iterator hint, Key const & key, Assign && assign, Args && ... args)
+  -> iterator {
+    if (auto nh = pool_ ? pool_->take() : typename map_type::node_type {}; !nh.empty()) {
+      try {
+        nh.key() = key;
+        assign(nh.mapped());
+      }
+      catch (...) {
+        pool_->give(std::move(nh));
+        throw;
+      }
+      ++stats_.reused;
+      return map_.insert(hint, std::move(nh));
+    }
+    ++stats_.allocated;
+    return map_.emplace_hint(hint, std::piecewise_construct, std::forward_as_tuple(key),
+                             std::forward_as_tuple(std::forward<Args>(args) ...));
+  }
+
+  auto recycle(typename map_type::node_type && nh) -> void {
+    if (pool_ && pool_->give(std::move(nh))) { ++stats_.recycled; }
+    else                            { ++stats_.dropped; }
+  }
+
+  map_type                   map_;
+  std::unique_ptr<pool_type> own_;
+  pool_type *                pool_;
+  recycle_stats              stats_;
+};
+
+} /* namespace cmaprec */
+
+#endif /* recycling_map_hpp */
@@ -0,0 +1,476 @@
+//
+//  small_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://llvm.org/docs/ProgrammersManual.html#llvm-adt-smallvector-h
+//  @see: https://en.cppreference.com/w/cpp/container/map
+//
+
+#ifndef small_map_hpp
+#define small_map_hpp
+
+#include <map>
+#include <array>
+#include <memory>
+#include <new>
+#include <utility>
+#include <tuple>
+#include <functional>
+#include <iterator>
+#include <initializer_list>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapsm
+namespace cmapsm {
+
+/*
+ *  MARK: small_map
+ *  std::map interface over N inline slots.  Up to N elements live inside
+ *  the object itself, so a map of a handful of entries costs no
+ *  allocation at all; the (N + 1)th insert moves everything into a
+ *  std::map, where it stays until clear().
+ *
+ *  Inline elements never move once built.  Key order is kept in a small
+ *  array of slot numbers, order_, which is what insert and erase shift:
+ *  order_[0, size) are the used slots in key order, order_[size, N) the
+ *  free ones.  Lookups are a linear scan of that array, which for a few
+ *  elements beats a tree's pointer chasing.  References to inline
+ *  elements stay valid until they are erased or the map spills.
+ */
+template <class Key, class T, std::size_t N = 8, class Compare = std::less<Key>>
+  requires (N > 0 && N <= 255)
+class small_map {
+public:
+  using map_type        = std::map<Key, T, Compare>;
+  using key_type        = Key;
+  using mapped_type     = T;
+  using value_type      = std::pair<Key const, T>;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare     = Compare;
+  using reference       = value_type &;
+  using const_reference = value_type const &;
+
+  static constexpr size_type inline_capacity = N;
+
+  //  MARK: iterator
+  template <bool Const>
+  class basic_iterator {
+    friend class small_map;
+    using owner_type = std::conditional_t<Const, small_map const, small_map>;
+    using base_type  = std::conditional_t<Const, typename map_type::const_iterator,
+                                                 typename map_type::iterator>;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = small_map::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using reference = std::conditional_t<Const, value_type const &, value_type &>;
+    using pointer   = std::conditional_t<Const, value_type const *, value_type *>;
+
+    basic_iterator() = default;
+    template <bool C = Const> requires C
+    basic_iterator(basic_iterator<false> const & other)
+      : owner_(other.owner_), pos_(other.pos_), base_(other.base_) {}
+
+    auto operator*() const -> reference {
+      return owner_->spilled_ ? *base_ : owner_->slot(owner_->order_[pos_]);
+    }
+    auto operator->() const -> pointer { return std::addressof(**this); }
+
+    auto operator++() -> basic_iterator & {
+      if (owner_->spilled_) { ++base_; } else { ++pos_; }
+      return *this;
+    }
+    auto operator++(int) -> basic_iterator { auto tmp = *this; ++*this; return tmp; }
+    auto operator--() -> basic_iterator & {
+      if (owner_->spilled_) { --base_; } else { --pos_; }
+      return *this;
+    }
+    auto operator--(int) -> basic_iterator { auto tmp = *this; --*this; return tmp; }
+
+    friend bool operator==(basic_iterator const & lhs, basic_iterator const & rhs) {
+      return lhs.equals(rhs);
+    }
+
+  private:
+    basic_iterator(owner_type * owner, size_type pos) : owner_(owner), pos_(pos) {}
+    basic_iterator(owner_type * owner, base_type base) : owner_(owner), base_(base) {}
+
+    auto equals(basic_iterator const & other) const -> bool {
+      if (owner_ == nullptr || other.owner_ == nullptr) { return owner_ == other.owner_; }
+      return owner_->spilled_ ? base_ == other.base_ : pos_ == other.pos_;
+    }
+
+    owner_type * owner_ = nullptr;
+    size_type    pos_   = 0;
+    base_type    base_ {};
+    friend class basic_iterator<!Const>;
+  };
+
+  using iterator               = basic_iterator<false>;
+  using const_iterator         = basic_iterator<true>;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  //  MARK: construction
+  small_map() noexcept(std::is_nothrow_default_constructible_v<Compare>) { reset_order(); }
+
+  explicit small_map(Compare const & comp) : comp_(comp), heap_(comp) { reset_order(); }
+
+  small_map(std::initializer_list<value_type> init, Compare const & comp = Compare())
+    : small_map(comp) {
+    insert(init);
+  }
+
+  template <std::input_iterator It>
+  small_map(It first, It last, Compare const & comp = Compare()) : small_map(comp) {
+    insert(first, last);
+  }
+
+  small_map(small_map const & other) : small_map(other.comp_) {
+    if (other.spilled_) { heap_ = other.heap_; spilled_ = true; return; }
+    for (auto const & value : other) { place(count_, value); }
+  }
+
+  // inline elements are moved one by one; a spilled tree is taken whole
+  small_map(small_map && other) : small_map(other.comp_) { adopt(std::move(other)); }
+
+  auto operator=(small_map const & other) -> small_map & {
+    if (this != &other) { *this = small_map(other); }
+    return *this;
+  }
+
+  auto operator=(small_map && other) -> small_map & {
+    if (this != &other) {
+      clear();
+      comp_ = other.comp_;
+      adopt(std::move(other));
+    }
+    return *this;
+  }
+
+  auto operator=(std::initializer_list<value_type> init) -> small_map & {
+    clear();
+    insert(init);
+    return *this;
+  }
+
+  ~small_map() { destroy_inline(); }
+
+  //  MARK: iterators
+  auto begin() noexcept -> iterator { return first_of<iterator>(this); }
+  auto end() noexcept -> iterator { return last_of<iterator>(this); }
+  auto begin() const noexcept -> const_iterator { return first_of<const_iterator>(this); }
+  auto end() const noexcept -> const_iterator { return last_of<const_iterator>(this); }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+  auto rbegin() noexcept { return reverse_iterator(end()); }
+  auto rend() noexcept { return reverse_iterator(begin()); }
+  auto rbegin() const noexcept { return const_reverse_iterator(end()); }
+  auto rend() const noexcept { return const_reverse_iterator(begin()); }
+  auto crbegin() const noexcept { return rbegin(); }
+  auto crend() const noexcept { return rend(); }
+
+  //  MARK: capacity
+  [[nodiscard]] auto empty() const noexcept -> bool { return size() == 0; }
+  auto size() const noexcept -> size_type { return spilled_ ? heap_.size() : count_; }
+  auto max_size() const noexcept -> size_type { return heap_.max_size(); }
+
+  // false once the elements have moved to the heap
+  auto is_inline() const noexcept -> bool { return !spilled_; }
+
+  //  MARK: lookup
+  auto key_comp() const -> key_compare { return comp_; }
+
+  auto lower_bound(Key const & key) -> iterator { return bound<iterator>(this, key, false); }
+  auto lower_bound(Key const & key) const -> const_iterator { return bound<const_iterator>(this, key, false); }
+  auto upper_bound(Key const & key) -> iterator { return bound<iterator>(this, key, true); }
+  auto upper_bound(Key const & key) const -> const_iterator { return bound<const_iterator>(this, key, true); }
+
+  auto find(Key const & key) -> iterator { return exact<iterator>(this, key); }
+  auto find(Key const & key) const -> const_iterator { return exact<const_iterator>(this, key); }
+
+  auto equal_range(Key const & key) { return std::pair(lower_bound(key), upper_bound(key)); }
+  auto equal_range(Key const & key) const { return std::pair(lower_bound(key), upper_bound(key)); }
+
+  auto contains(Key const & key) const -> bool { return find(key) != end(); }
+  auto count(Key const & key) const -> size_type { return contains(key) ? 1 : 0; }
+
+  auto at(Key const & key) -> T & {
+    if (auto it = find(key); it != end()) { return it->second; }
+    throw std::out_of_range("small_map::at");
+  }
+  auto at(Key const & key) const -> T const & {
+    if (auto it = find(key); it != end()) { return it->second; }
+    throw std::out_of_range("small_map::at");
+  }
+
+  auto operator[](Key const & key) -> T & requires std::is_default_constructible_v<T> {
+    return try_emplace(key).first->second;
+  }
+  auto operator[](Key && key) -> T & requires std::is_default_constructible_v<T> {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  //  MARK: modifiers
+  template <class K, class ... Args>
+    requires std::is_constructible_v<Key, K &&>
+  auto try_emplace(K && key, Args && ... args) -> std::pair<iterator, bool> {
+    if (spilled_) {
+      auto [it, done] = heap_.try_emplace(std::forward<K>(key), std::forward<Args>(args) ...);
+      return { iterator(this, it), done };
+    }
+    auto const pos = position(key);
+    if (pos < count_ && !comp_(key, slot(order_[pos]).first)) { return { iterator(this, pos), false }; }
+    if (count_ == N) {
+      spill();
+      auto it = heap_.try_emplace(std::forward<K>(key), std::forward<Args>(args) ...).first;
+      return { iterator(this, it), true };
+    }
+    place(pos, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+          std::forward_as_tuple(std::forward<Args>(args) ...));
+    return { iterator(this, pos), true };
+  }
+
+  // built in a free slot first, since the key is only known afterwards
+  template <class ... Args>
+  auto emplace(Args && ... args) -> std::pair<iterator, bool> {
+    if (spilled_) {
+      auto [it, done] = heap_.emplace(std::forward<Args>(args) ...);
+      return { iterator(this, it), done };
+    }
+    if (count_ == N) {
+      auto value = value_type(std::forward<Args>(args) ...);
+      return try_emplace(value.first, std::move(value.second));
+    }
+    auto const free = build(std::forward<Args>(args) ...);
+    auto const & key = slot(free).first;
+    auto const pos = position(key);
+    if (pos < count_ && !comp_(key, slot(order_[pos]).first)) {
+      std::destroy_at(std::addressof(slot(free)));
+      return { iterator(this, pos), false };
+    }
+    link(pos);
+    return { iterator(this, pos), true };
+  }
+
+  // inline, the hint is checked against its two neighbours in order_, and
+  //  a wrong one costs the scan emplace does anyway; spilled, it goes to
+  //  the tree
+  template <class ... Args>
+  auto emplace_hint(const_iterator hint, Args && ... args) -> iterator {
+    if (spilled_) { return iterator(this, heap_.emplace_hint(hint.base_, std::forward<Args>(args) ...)); }
+    if (count_ == N) { return emplace(std::forward<Args>(args) ...).first; }
+    auto const free = build(std::forward<Args>(args) ...);
+    auto const & key = slot(free).first;
+    auto pos = hint.pos_;
+    auto const fits = (pos == 0 || comp_(slot(order_[pos - 1]).first, key))
+                   && (pos == count_ || comp_(key, slot(order_[pos]).first));
+    if (!fits) {
+      pos = position(key);
+      if (pos < count_ && !comp_(key, slot(order_[pos]).first)) {
+        std::destroy_at(std::addressof(slot(free)));
+        return iterator(this, pos);
+      }
+    }
+    link(pos);
+    return iterator(this, pos);
+  }
+
+  auto insert(value_type const & value) -> std::pair<iterator, bool> {
+    return try_emplace(value.first, value.second);
+  }
+  auto insert(value_type && value) -> std::pair<iterator, bool> { return emplace(std::move(value)); }
+  auto insert(const_iterator hint, value_type const & value) -> iterator { return emplace_hint(hint, value); }
+  auto insert(const_iterator hint, value_type && value) -> iterator {
+    return emplace_hint(hint, std::move(value));
+  }
+
+  template <std::input_iterator It>
+  auto insert(It first, It last) -> void {
+    for (; first != last; ++first) { insert(*first); }
+  }
+  auto insert(std::initializer_list<value_type> init) -> void { insert(init.begin(), init.end()); }
+
+  template <class K, class M>
+    requires std::is_constructible_v<Key, K &&>
+  auto insert_or_assign(K && key, M && obj) -> std::pair<iterator, bool> {
+    auto [it, done] = try_emplace(std::forward<K>(key), std::forward<M>(obj));
+    if (!done) { it->second = std::forward<M>(obj); }
+    return { it, done };
+  }
+
+  auto erase(const_iterator pos) -> iterator {
+    if (spilled_) { return iterator(this, heap_.erase(pos.base_)); }
+    auto const ix = pos.pos_;
+    auto const free = order_[ix];
+    std::destroy_at(std::addressof(slot(free)));
+    std::copy(order_.begin() + ix + 1, order_.begin() + count_, order_.begin() + ix);
+    order_[--count_] = free;
+    return iterator(this, ix);
+  }
+  auto erase(iterator pos) -> iterator { return erase(const_iterator(pos)); }
+
+  auto erase(const_iterator first, const_iterator last) -> iterator {
+    if (spilled_) { return iterator(this, heap_.erase(first.base_, last.base_)); }
+    for (auto todo = last.pos_ - first.pos_; todo > 0; --todo) { erase(first); }
+    return iterator(this, first.pos_);
+  }
+
+  auto erase(Key const & key) -> size_type {
+    auto it = find(key);
+    if (it == end()) { return 0; }
+    erase(it);
+    return 1;
+  }
+
+  // back to inline storage
+  auto clear() noexcept -> void {
+    destroy_inline();
+    heap_.clear();
+    spilled_ = false;
+  }
+
+  auto swap(small_map & other) -> void {
+    auto tmp = std::move(other);
+    other = std::move(*this);
+    *this = std::move(tmp);
+  }
+
+  friend auto operator==(small_map const & lhs, small_map const & rhs) -> bool {
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+
+private:
+  using slot_storage = std::array<std::byte, sizeof(value_type)>;
+
+  auto slot(std::size_t ix) noexcept -> value_type & {
+    return *std::launder(reinterpret_cast<value_type *>(slots_[ix].data()));
+  }
+  auto slot(std::size_t ix) const noexcept -> value_type const & {
+    return *std::launder(reinterpret_cast<value_type const *>(slots_[ix].data()));
+  }
+
+  auto reset_order() noexcept -> void {
+    for (std::size_t ix = 0; ix < N; ++ix) { order_[ix] = static_cast<std::uint8_t>(ix); }
+    count_ = 0;
+  }
+
+  auto destroy_inline() noexcept -> void {
+    for (std::size_t ix = 0; ix < count_; ++ix) { std::destroy_at(std::addressof(slot(order_[ix]))); }
+    reset_order();
+  }
+
+  // first position whose key is not less than key
+  auto position(Key const & key) const -> size_type {
+    size_type pos = 0;
+    while (pos < count_ && comp_(slot(order_[pos]).first, key)) { ++pos; }
+    return pos;
+  }
+
+  // construct an element in the first free slot, not yet linked in
+  template <class ... Args>
+  auto build(Args && ... args) -> std::size_t {
+    auto const free = order_[count_];
+    std::construct_at(reinterpret_cast<value_type *>(slots_[free].data()), std::forward<Args>(args) ...);
+    return free;
+  }
+
+  // splice the slot just built in at key position pos
+  auto link(size_type pos) noexcept -> void {
+    auto const free = order_[count_];
+    std::copy_backward(order_.begin() + pos, order_.begin() + count_, order_.begin() + count_ + 1);
+    order_[pos] = free;
+    ++count_;
+  }
+
+  template <class ... Args>
+  auto place(size_type pos, Args && ... args) -> void {
+    build(std::forward<Args>(args) ...);
+    link(pos);
+  }
+
+  // this is empty; take other's elements and leave it empty
+  auto adopt(small_map && other) -> void {
+    if (other.spilled_) {
+      heap_ = std::move(other.heap_);
+      spilled_ = true;
+    }
+    else {
+      for (auto & value : other) { place(count_, std::move(value)); }
+    }
+    other.clear();
+  }
+
+  // all-or-nothing: the inline elements are dropped only once the tree is
+  //  built.  Values are moved only when that cannot throw (else copied),
+  //  and if building the tree fails they are moved back before rethrowing.
+  auto spill() -> void {
+    auto heap = map_type(comp_);
+    std::size_t ix = 0;
+    try {
+      for (; ix < count_; ++ix) {
+        auto & value = slot(order_[ix]);
+        heap.emplace_hint(heap.end(), value.first, std::move_if_noexcept(value.second));
+      }
+    }
+    catch (...) {
+      if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+        auto back = heap.begin();   // the first ix slots, in the same order
+        for (std::size_t jx = 0; jx < ix; ++jx, ++back) { slot(order_[jx]).second = std::move(back->second); }
+      }
+      throw;
+    }
+    destroy_inline();
+    heap_ = std::move(heap);
+    spilled_ = true;
+  }
+
+  template <class It, class Self>
+  static auto first_of(Self * self) -> It {
+    return self->spilled_ ? It(self, self->heap_.begin()) : It(self, size_type { 0 });
+  }
+  template <class It, class Self>
+  static auto last_of(Self * self) -> It {
+    return self->spilled_ ? It(self, self->heap_.end()) : It(self, size_type { self->count_ });
+  }
+
+  template <class It, class Self>
+  static auto bound(Self * self, Key const & key, bool upper) -> It {
+    if (self->spilled_) {
+      return It(self, upper ? self->heap_.upper_bound(key) : self->heap_.lower_bound(key));
+    }
+    auto pos = self->position(key);
+    if (upper && pos < self->count_ && !self->comp_(key, self->slot(self->order_[pos]).first)) { ++pos; }
+    return It(self, pos);
+  }
+
+  template <class It, class Self>
+  static auto exact(Self * self, Key const & key) -> It {
+    if (self->spilled_) { return It(self, self->heap_.find(key)); }
+    auto const pos = self->position(key);
+    if (pos < self->count_ && !self->comp_(key, self->slot(self->order_[pos]).first)) {
+      return It(self, pos);
+    }
+    return last_of<It>(self);
+  }
+
+  alignas(value_type) std::array<slot_storage, N> slots_;
+  std::array<std::uint8_t, N> order_;
+  std::uint8_t                count_   = 0;
+  bool                        spilled_ = false;
+  [[no_unique_address]] Compare comp_ {};
+  map_type                    heap_;
+};
+
+} /* namespace cmapsm */
+
+#endif /* small_map_hpp */
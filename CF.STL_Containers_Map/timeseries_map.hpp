@@ -0,0 +1,606 @@
+//
+//  timeseries_map.hpp
+//  CF.STL_Containers_Map
+//
+//  MARK: - Reference.
+//  @see: https://en.cppreference.com/w/cpp/chrono/year_month_day
+//  @see: https://en.wikipedia.org/wiki/LEB128
+//  @see: Pelkonen et al., "Gorilla: A Fast, Scalable, In-Memory Time Series Database"
+//
+
+#ifndef timeseries_map_hpp
+#define timeseries_map_hpp
+
+#include <chrono>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <initializer_list>
+#include <stdexcept>
+#include <algorithm>
+#include <concepts>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+//  MARK: - Definitions
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+//  MARK: namespace cmapts
+namespace cmapts {
+
+/*
+ *  MARK: time_key
+ *  Order-preserving packing of a time key into an int64: days since the
+ *  epoch for year_month_day, ticks for a time_point with an integral
+ *  representation, the value itself for signed (or narrow) integers.
+ */
+template <class Key>
+struct time_key;
+
+template <>
+struct time_key<std::chrono::year_month_day> {
+  static auto encode(std::chrono::year_month_day const & ymd) -> std::int64_t {
+    return std::chrono::sys_days(ymd).time_since_epoch().count();
+  }
+  static auto decode(std::int64_t bits) -> std::chrono::year_month_day {
+    return std::chrono::year_month_day(std::chrono::sys_days(std::chrono::days(bits)));
+  }
+};
+
+template <class Clock, class Duration>
+  requires std::integral<typename Duration::rep>
+struct time_key<std::chrono::time_point<Clock, Duration>> {
+  using time_point = std::chrono::time_point<Clock, Duration>;
+  static auto encode(time_point const & tp) -> std::int64_t {
+    return static_cast<std::int64_t>(tp.time_since_epoch().count());
+  }
+  static auto decode(std::int64_t bits) -> time_point {
+    return time_point(Duration(static_cast<typename Duration::rep>(bits)));
+  }
+};
+
+template <std::integral I>
+  requires (std::signed_integral<I> || sizeof(I) < sizeof(std::int64_t))
+struct time_key<I> {
+  static constexpr auto encode(I value) -> std::int64_t { return static_cast<std::int64_t>(value); }
+  static constexpr auto decode(std::int64_t bits) -> I { return static_cast<I>(bits); }
+};
+
+template <class Key>
+concept time_keyed = requires(Key const & key, std::int64_t bits) {
+  { time_key<Key>::encode(key) } -> std::same_as<std::int64_t>;
+  { time_key<Key>::decode(bits) } -> std::same_as<Key>;
+};
+
+//  ....+....!....+....!....+....!....+....!....+....!....+....!....+....!....+....!
+/*
+ *  MARK: timeseries_map
+ *  Ordered map from a time key to T, stored as a vector of chunks of up
+ *  to ChunkSize elements.  Within a chunk the keys are kept as LEB128
+ *  varints of the gap to the previous key: a daily or per-second series
+ *  costs about one byte per key instead of a 48-byte tree node.  The
+ *  terminating byte of every varint has its high bit clear, so the
+ *  stream can be stepped backwards as cheaply as forwards and reverse
+ *  iteration needs no decoding buffer.
+ *
+ *    - appending a key later than every other one is O(1);
+ *    - lower_bound is a binary search over chunks, then over restart
+ *      points stored every restart_interval keys, then at most
+ *      restart_interval varint steps;
+ *    - an out-of-order insert or an erase re-encodes one chunk, O(ChunkSize).
+ *
+ *  Keys are unique, as in std::map.  Iterators yield a
+ *  std::pair<Key, T &> by value (keys only exist in decoded form) and,
+ *  as with std::vector, any insert or erase invalidates them.
+ */
+template <time_keyed Key, class T, std::size_t ChunkSize = 512>
+  requires (ChunkSize >= 2)
+class timeseries_map {
+public:
+  using key_type    = Key;
+  using mapped_type = T;
+  using value_type  = std::pair<Key, T>;
+  using size_type   = std::size_t;
+
+  static constexpr size_type chunk_size = ChunkSize;
+  static constexpr size_type restart_interval = 32;
+
+private:
+  using traits = time_key<Key>;
+
+  struct restart {
+    std::int64_t key;
+    size_type    offset;  // first byte of the gap to the next key
+  };
+
+  struct chunk {
+    std::int64_t              first = 0;
+    std::int64_t              last  = 0;
+    std::vector<std::uint8_t> gaps;
+    std::vector<restart>      restarts;
+    std::vector<T>            values;
+
+    auto size() const noexcept -> size_type { return values.size(); }
+  };
+
+public:
+  //  MARK: iterator
+  template <bool Const>
+  class basic_iterator {
+    friend class timeseries_map;
+    using owner_type = std::conditional_t<Const, timeseries_map const, timeseries_map>;
+
+  public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type        = timeseries_map::value_type;
+    using difference_type   = std::ptrdiff_t;
+    using reference = std::pair<Key, std::conditional_t<Const, T const &, T &>>;
+
+    struct pointer {
+      reference ref;
+      auto operator->() -> reference * { return &ref; }
+    };
+
+    basic_iterator() = default;
+    template <bool C = Const> requires C
+    basic_iterator(basic_iterator<false> const & other)
+      : owner_(other.owner_), ci_(other.ci_), ix_(other.ix_), off_(other.off_), key_(other.key_) {}
+
+    auto key() const -> Key { return traits::decode(key_); }
+    auto operator*() const -> reference {
+      return { traits::decode(key_), owner_->chunks_[ci_].values[ix_] };
+    }
+    auto operator->() const -> pointer { return { **this }; }
+
+    auto operator++() -> basic_iterator & {
+      auto const & chk = owner_->chunks_[ci_];
+      if (ix_ + 1 < chk.size()) {
+        key_ = advance(key_, read_forward(chk.gaps, off_));
+        ++ix_;
+      }
+      else if (++ci_ < owner_->chunks_.size()) {
+        ix_ = 0; off_ = 0; key_ = owner_->chunks_[ci_].first;
+      }
+      else {
+        ix_ = 0; off_ = 0; key_ = 0;  // end()
+      }
+      return *this;
+    }
+    auto operator++(int) -> basic_iterator { auto tmp = *this; ++*this; return tmp; }
+
+    auto operator--() -> basic_iterator & {
+      if (ix_ > 0) {
+        auto const & chk = owner_->chunks_[ci_];
+        key_ = retreat(key_, read_backward(chk.gaps, off_));
+        --ix_;
+      }
+      else {
+        auto const & chk = owner_->chunks_[--ci_];
+        ix_ = chk.size() - 1; off_ = chk.gaps.size(); key_ = chk.last;
+      }
+      return *this;
+    }
+    auto operator--(int) -> basic_iterator { auto tmp = *this; --*this; return tmp; }
+
+    friend bool operator==(basic_iterator const & lhs, basic_iterator const & rhs) {
+      return lhs.ci_ == rhs.ci_ && lhs.ix_ == rhs.ix_;
+    }
+
+  private:
+    basic_iterator(owner_type * owner, size_type ci, size_type ix, size_type off, std::int64_t key)
+      : owner_(owner), ci_(ci), ix_(ix), off_(off), key_(key) {}
+
+    owner_type * owner_ = nullptr;
+    size_type    ci_  = 0;
+    size_type    ix_  = 0;
+    size_type    off_ = 0;
+    std::int64_t key_ = 0;
+    friend class basic_iterator<!Const>;
+  };
+
+  using iterator               = basic_iterator<false>;
+  using const_iterator         = basic_iterator<true>;
+  using reverse_iterator       = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  //  MARK: construction
+  timeseries_map() = default;
+
+  timeseries_map(std::initializer_list<value_type> init) {
+    insert(init.begin(), init.end());
+  }
+
+  template <std::input_iterator It>
+  timeseries_map(It first, It last) { insert(first, last); }
+
+  //  MARK: iterators
+  auto begin() noexcept -> iterator { return first_of<iterator>(this); }
+  auto end() noexcept -> iterator { return { this, chunks_.size(), 0, 0, 0 }; }
+  auto begin() const noexcept -> const_iterator { return first_of<const_iterator>(this); }
+  auto end() const noexcept -> const_iterator { return { this, chunks_.size(), 0, 0, 0 }; }
+  auto cbegin() const noexcept -> const_iterator { return begin(); }
+  auto cend() const noexcept -> const_iterator { return end(); }
+  auto rbegin() noexcept { return reverse_iterator(end()); }
+  auto rend() noexcept { return reverse_iterator(begin()); }
+  auto rbegin() const noexcept { return const_reverse_iterator(end()); }
+  auto rend() const noexcept { return const_reverse_iterator(begin()); }
+  auto crbegin() const noexcept { return rbegin(); }
+  auto crend() const noexcept { return rend(); }
+
+  //  MARK: capacity
+  [[nodiscard]] auto empty() const noexcept -> bool { return size_ == 0; }
+  auto size() const noexcept -> size_type { return size_; }
+  auto chunk_count() const noexcept -> size_type { return chunks_.size(); }
+
+  // bytes spent on keys: varint gaps, restart points and chunk bounds
+  auto key_bytes() const noexcept -> size_type {
+    size_type bytes = 0;
+    for (auto const & chk : chunks_) {
+      bytes += chk.gaps.capacity() + chk.restarts.capacity() * sizeof(restart)
+             + sizeof(chk.first) + sizeof(chk.last);
+    }
+    return bytes;
+  }
+
+  //  MARK: lookup
+  auto lower_bound(Key const & key) -> iterator { return seek<iterator>(this, traits::encode(key)); }
+  auto lower_bound(Key const & key) const -> const_iterator {
+    return seek<const_iterator>(this, traits::encode(key));
+  }
+
+  auto upper_bound(Key const & key) -> iterator { return after<iterator>(this, traits::encode(key)); }
+  auto upper_bound(Key const & key) const -> const_iterator {
+    return after<const_iterator>(this, traits::encode(key));
+  }
+
+  auto find(Key const & key) -> iterator { return exact<iterator>(this, traits::encode(key)); }
+  auto find(Key const & key) const -> const_iterator {
+    return exact<const_iterator>(this, traits::encode(key));
+  }
+
+  auto contains(Key const & key) const -> bool { return find(key) != end(); }
+  auto count(Key const & key) const -> size_type { return contains(key) ? 1 : 0; }
+
+  auto equal_range(Key const & key) { return std::pair(lower_bound(key), upper_bound(key)); }
+  auto equal_range(Key const & key) const { return std::pair(lower_bound(key), upper_bound(key)); }
+
+  auto at(Key const & key) -> T & { return const_cast<T &>(std::as_const(*this).at(key)); }
+  auto at(Key const & key) const -> T const & {
+    auto it = find(key);
+    if (it == end()) { throw std::out_of_range("cmapts::timeseries_map::at"); }
+    return chunks_[it.ci_].values[it.ix_];
+  }
+
+  auto operator[](Key const & key) -> T & requires std::default_initializable<T> {
+    auto it = try_emplace(key).first;
+    return chunks_[it.ci_].values[it.ix_];
+  }
+
+  //  MARK: modifiers
+  template <class ... Args>
+  auto try_emplace(Key const & key, Args && ... args) -> std::pair<iterator, bool> {
+    auto const bits = traits::encode(key);
+    if (chunks_.empty() || bits > chunks_.back().last) {
+      return { append(bits, T(std::forward<Args>(args) ...)), true };
+    }
+    auto it = seek<iterator>(this, bits);
+    if (it.key_ == bits) { return { it, false }; }
+    return { insert_into(it.ci_, it.ix_, bits, T(std::forward<Args>(args) ...)), true };
+  }
+
+  template <class ... Args>
+  auto emplace(Key const & key, Args && ... args) -> std::pair<iterator, bool> {
+    return try_emplace(key, std::forward<Args>(args) ...);
+  }
+
+  auto insert(value_type const & value) -> std::pair<iterator, bool> {
+    return try_emplace(value.first, value.second);
+  }
+
+  auto insert(value_type && value) -> std::pair<iterator, bool> {
+    return try_emplace(value.first, std::move(value.second));
+  }
+
+  template <std::input_iterator It>
+  auto insert(It first, It last) -> void {
+    for (; first != last; ++first) { insert(*first); }
+  }
+
+  template <class M>
+  auto insert_or_assign(Key const & key, M && obj) -> std::pair<iterator, bool> {
+    auto result = try_emplace(key, std::forward<M>(obj));
+    if (!result.second) {
+      chunks_[result.first.ci_].values[result.first.ix_] = std::forward<M>(obj);
+    }
+    return result;
+  }
+
+  auto erase(Key const & key) -> size_type {
+    auto it = find(key);
+    if (it == end()) { return 0; }
+    erase(it);
+    return 1;
+  }
+
+  // the chunk is rebuilt aside and swapped in, so a throw leaves the map as it was
+  auto erase(const_iterator pos) -> iterator {
+    auto const bits = pos.key_;
+    auto const ci = pos.ci_;
+    auto & old = chunks_[ci];
+    if (old.size() == 1) {
+      chunks_.erase(chunks_.begin() + static_cast<std::ptrdiff_t>(ci));
+    }
+    else {
+      auto keys = unpack(old);
+      keys.erase(keys.begin() + static_cast<std::ptrdiff_t>(pos.ix_));
+      auto fresh = pack(keys);
+      take(fresh, old.values, 0, pos.ix_);
+      take(fresh, old.values, pos.ix_ + 1, old.size());
+      old = std::move(fresh);
+    }
+    --size_;
+    return seek<iterator>(this, bits);
+  }
+
+  /*
+   *  Drop every element older than cutoff.  Whole chunks go without
+   *  being decoded; only the chunk straddling cutoff is re-encoded.
+   *  Returns the number of elements removed.
+   */
+  auto erase_before(Key const & cutoff) -> size_type {
+    auto const bits = traits::encode(cutoff);
+    auto const whole = static_cast<size_type>(std::partition_point(
+      chunks_.begin(), chunks_.end(),
+      [bits](chunk const & chk) { return chk.last < bits; }) - chunks_.begin());
+
+    size_type removed = 0;
+    for (size_type ci = 0; ci < whole; ++ci) { removed += chunks_[ci].size(); }
+
+    // re-encode the straddling chunk first: only it can throw
+    if (whole < chunks_.size() && chunks_[whole].first < bits) {
+      auto & old = chunks_[whole];
+      auto keys = unpack(old);
+      auto const cut = std::lower_bound(keys.begin(), keys.end(), bits) - keys.begin();
+      keys.erase(keys.begin(), keys.begin() + cut);
+      auto fresh = pack(keys);
+      take(fresh, old.values, static_cast<size_type>(cut), old.size());
+      old = std::move(fresh);
+      removed += static_cast<size_type>(cut);
+    }
+    chunks_.erase(chunks_.begin(), chunks_.begin() + static_cast<std::ptrdiff_t>(whole));
+    size_ -= removed;
+    return removed;
+  }
+
+  auto clear() noexcept -> void {
+    chunks_.clear();
+    size_ = 0;
+  }
+
+  auto swap(timeseries_map & other) noexcept -> void {
+    chunks_.swap(other.chunks_);
+    std::swap(size_, other.size_);
+  }
+
+  friend auto swap(timeseries_map & lhs, timeseries_map & rhs) noexcept -> void {
+    lhs.swap(rhs);
+  }
+
+  friend auto operator==(timeseries_map const & lhs, timeseries_map const & rhs) -> bool {
+    return lhs.size() == rhs.size()
+        && std::equal(lhs.begin(), lhs.end(), rhs.begin(),
+                      [](auto const & le, auto const & re) {
+                        return le.first == re.first && le.second == re.second;
+                      });
+  }
+
+private:
+  //  MARK: varint gaps
+  static auto write_gap(std::vector<std::uint8_t> & gaps, std::uint64_t gap) -> void {
+    while (gap >= 0x80) {
+      gaps.push_back(static_cast<std::uint8_t>(gap | 0x80));
+      gap >>= 7;
+    }
+    gaps.push_back(static_cast<std::uint8_t>(gap));
+  }
+
+  // gaps are written modulo 2^64 (push), so keys step the same way: a
+  //  gap above INT64_MAX, as from INT64_MIN to INT64_MAX, must not overflow
+  static constexpr auto advance(std::int64_t bits, std::uint64_t gap) noexcept -> std::int64_t {
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(bits) + gap);
+  }
+  static constexpr auto retreat(std::int64_t bits, std::uint64_t gap) noexcept -> std::int64_t {
+    return static_cast<std::int64_t>(static_cast<std::uint64_t>(bits) - gap);
+  }
+
+  static auto read_forward(std::vector<std::uint8_t> const & gaps, size_type & off)
+  -> std::uint64_t {
+    std::uint64_t gap = 0;
+    for (unsigned shift = 0; ; shift += 7) {
+      auto const byte = gaps[off++];
+      gap |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) { return gap; }
+    }
+  }
+
+  // off is one past the terminating byte of the gap to read
+  static auto read_backward(std::vector<std::uint8_t> const & gaps, size_type & off)
+  -> std::uint64_t {
+    auto start = off - 1;
+    while (start > 0 && (gaps[start - 1] & 0x80) != 0) { --start; }
+    off = start;
+    return read_forward(gaps, start);
+  }
+
+  //  MARK: chunk encoding
+  // bits as the key at position ix of chk; its value is stored apart
+  static auto encode(chunk & chk, size_type ix, std::int64_t bits) -> void {
+    if (ix == 0) {
+      chk.first = bits;
+      chk.restarts.push_back({ bits, 0 });
+    }
+    else {
+      write_gap(chk.gaps, static_cast<std::uint64_t>(bits) - static_cast<std::uint64_t>(chk.last));
+      if (ix % restart_interval == 0) {
+        chk.restarts.push_back({ bits, chk.gaps.size() });
+      }
+    }
+    chk.last = bits;
+  }
+
+  // on a throw chk is as it was
+  static auto push(chunk & chk, std::int64_t bits, T && value) -> void {
+    auto const gaps = chk.gaps.size();
+    auto const restarts = chk.restarts.size();
+    auto const last = chk.last;
+    try {
+      encode(chk, chk.size(), bits);
+      chk.values.push_back(std::move(value));
+    } catch (...) {
+      chk.gaps.resize(gaps);
+      chk.restarts.resize(restarts);
+      chk.last = last;
+      throw;
+    }
+  }
+
+  // a full chunk will only be re-encoded, never grown in place
+  static auto seal(chunk & chk) -> void {
+    chk.gaps.shrink_to_fit();
+    chk.restarts.shrink_to_fit();
+    chk.values.shrink_to_fit();
+  }
+
+  static auto unpack(chunk const & chk) -> std::vector<std::int64_t> {
+    std::vector<std::int64_t> keys;
+    keys.reserve(chk.size());
+    auto bits = chk.first;
+    size_type off = 0;
+    keys.push_back(bits);
+    while (off < chk.gaps.size()) {
+      bits = advance(bits, read_forward(chk.gaps, off));
+      keys.push_back(bits);
+    }
+    return keys;
+  }
+
+  // a sealed chunk of keys, with room reserved for their values; take()
+  //  fills it without allocating
+  static auto pack(std::vector<std::int64_t> const & keys) -> chunk {
+    chunk chk;
+    for (size_type ix = 0; ix < keys.size(); ++ix) { encode(chk, ix, keys[ix]); }
+    chk.gaps.shrink_to_fit();
+    chk.restarts.shrink_to_fit();
+    chk.values.reserve(keys.size());
+    return chk;
+  }
+
+  // values [first, last) onto chk; moved only where that cannot throw, so
+  //  the source chunk survives a throwing copy intact
+  static auto take(chunk & chk, std::vector<T> & values, size_type first, size_type last) -> void {
+    for (; first < last; ++first) { chk.values.push_back(std::move_if_noexcept(values[first])); }
+  }
+
+  auto append(std::int64_t bits, T && value) -> iterator {
+    if (chunks_.empty() || chunks_.back().size() == ChunkSize) {
+      if (!chunks_.empty()) { seal(chunks_.back()); }
+      chunks_.emplace_back();
+    }
+    auto & tail = chunks_.back();
+    try {
+      push(tail, bits, std::move(value));
+    } catch (...) {
+      if (tail.values.empty()) { chunks_.pop_back(); }
+      throw;
+    }
+    ++size_;
+    return { this, chunks_.size() - 1, tail.size() - 1, tail.gaps.size(), bits };
+  }
+
+  // element bits goes before position ix of chunk ci; split when over-full.
+  //  The new chunk(s) are built aside and moved in, so a throw leaves the
+  //  map as it was
+  auto insert_into(size_type ci, size_type ix, std::int64_t bits, T && value) -> iterator {
+    auto keys = unpack(chunks_[ci]);
+    keys.insert(keys.begin() + static_cast<std::ptrdiff_t>(ix), bits);
+    auto const split = keys.size() > ChunkSize;
+    if (split) { chunks_.reserve(chunks_.size() + 1); }  // the insert below cannot throw
+    auto & old = chunks_[ci];
+
+    // element k of the chunk after the insert, value at ix
+    auto fill = [&](chunk & chk, size_type first, size_type last) {
+      for (auto k = first; k < last; ++k) {
+        if (k == ix) { chk.values.push_back(std::move(value)); }
+        else { chk.values.push_back(std::move_if_noexcept(old.values[k < ix ? k : k - 1])); }
+      }
+    };
+
+    if (!split) {
+      auto fresh = pack(keys);
+      fill(fresh, 0, keys.size());
+      old = std::move(fresh);
+    }
+    else {
+      auto const half = keys.size() / 2;
+      auto lower = pack({ keys.begin(), keys.begin() + static_cast<std::ptrdiff_t>(half) });
+      auto upper = pack({ keys.begin() + static_cast<std::ptrdiff_t>(half), keys.end() });
+      fill(lower, 0, half);
+      fill(upper, half, keys.size());
+      old = std::move(lower);
+      chunks_.insert(chunks_.begin() + static_cast<std::ptrdiff_t>(ci) + 1, std::move(upper));
+    }
+    ++size_;
+    return seek<iterator>(this, bits);
+  }
+
+  //  MARK: search
+  template <class It, class Self>
+  static auto first_of(Self * self) -> It {
+    if (self->chunks_.empty()) { return It(self, 0, 0, 0, 0); }
+    return It(self, 0, 0, 0, self->chunks_.front().first);
+  }
+
+  template <class It, class Self>
+  static auto seek(Self * self, std::int64_t bits) -> It {
+    auto const & chunks = self->chunks_;
+    auto const cit = std::partition_point(chunks.begin(), chunks.end(),
+      [bits](chunk const & chk) { return chk.last < bits; });
+    if (cit == chunks.end()) { return It(self, chunks.size(), 0, 0, 0); }
+
+    auto const & chk = *cit;
+    auto const ci = static_cast<size_type>(cit - chunks.begin());
+    auto rit = std::partition_point(chk.restarts.begin(), chk.restarts.end(),
+      [bits](restart const & rst) { return rst.key <= bits; });
+    if (rit == chk.restarts.begin()) { return It(self, ci, 0, 0, chk.first); }
+    --rit;
+
+    auto ix  = static_cast<size_type>(rit - chk.restarts.begin()) * restart_interval;
+    auto off = rit->offset;
+    auto key = rit->key;
+    while (key < bits) {  // chk.last >= bits bounds the walk
+      key = advance(key, read_forward(chk.gaps, off));
+      ++ix;
+    }
+    return It(self, ci, ix, off, key);
+  }
+
+  template <class It, class Self>
+  static auto exact(Self * self, std::int64_t bits) -> It {
+    auto it = seek<It>(self, bits);
+    return it != self->end() && it.key_ == bits ? it : self->end();
+  }
+
+  template <class It, class Self>
+  static auto after(Self * self, std::int64_t bits) -> It {
+    auto it = seek<It>(self, bits);
+    if (it != self->end() && it.key_ == bits) { ++it; }
+    return it;
+  }
+
+  std::vector<chunk> chunks_;
+  size_type          size_ = 0;
+};
+
+} /* namespace cmapts */
+
+#endif /* timeseries_map_hpp */